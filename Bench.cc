@@ -0,0 +1,100 @@
+/* Measures how much faster parallel search reaches a fixed depth. Every
+   built-in position is searched by a fresh engine with 1, 2, 4, ... threads,
+   in each of the parallel modes, and time to depth is compared with the
+   single-threaded one.
+
+   Usage:
+     bench [options]
+
+   Options:
+     -d <depth>     search depth (default: 7)
+     -t <threads>   maximum number of threads (default: number of cores)
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "Board.h"
+#include "Engine.h"
+#include "Stopwatch.h"
+#include "utils/Utils.h"
+
+
+namespace {
+
+const std::vector<const char*> BenchPositions = {
+  "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+  "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+  "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+  "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+  "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+  "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10"
+};
+
+// Returns total time of searching all positions.
+double RunBench(unsigned depth, unsigned threads, ParallelMode mode) {
+  double total_seconds = 0.0;
+  uint64_t total_nodes = 0u;
+  for (const auto fen: BenchPositions) {
+    Board board(fen);
+    Engine engine(depth);
+    engine.SetThreads(threads);
+    engine.SetParallelMode(mode);
+    Stopwatch stopwatch;
+    engine.CalculateBestMove(board);
+    total_seconds += stopwatch.Seconds();
+    total_nodes += engine.NodesCalculated();
+  }
+  std::cout << (mode == ParallelMode::SHARED_HASH ? "Shared hash" : "Work stealing")
+            << ", threads: " << threads << ", nodes: " << total_nodes << ", time: " << total_seconds << "s";
+  if (total_seconds > 0.0) {
+    std::cout << ", NPS: " << static_cast<uint64_t>(total_nodes / total_seconds);
+  }
+  return total_seconds;
+}
+
+int PrintUsage(const char* name) {
+  std::cerr << "Usage: " << name << " [-d <depth>] [-t <threads>]" << std::endl;
+  return 1;
+}
+
+}  // unnamed namespace
+
+
+int main(int argc, char* argv[]) {
+  unsigned depth = 7u;
+  unsigned max_threads = std::max(std::thread::hardware_concurrency(), 1u);
+  int arg = 1;
+  for (; arg + 1 < argc && argv[arg][0] == '-'; arg += 2) {
+    if (!strcmp(argv[arg], "-d")) {
+      if (!utils::str_2_number(argv[arg + 1], depth) || depth == 0u) {
+        return PrintUsage(argv[0]);
+      }
+    } else if (!strcmp(argv[arg], "-t")) {
+      if (!utils::str_2_number(argv[arg + 1], max_threads) || max_threads == 0u) {
+        return PrintUsage(argv[0]);
+      }
+    } else {
+      return PrintUsage(argv[0]);
+    }
+  }
+  if (arg != argc) {
+    return PrintUsage(argv[0]);
+  }
+  const double single_thread_seconds = RunBench(depth, 1u, ParallelMode::SHARED_HASH);
+  std::cout << std::endl;
+  for (const auto mode: {ParallelMode::SHARED_HASH, ParallelMode::WORK_STEALING}) {
+    for (unsigned threads = 2u; threads <= max_threads; threads *= 2u) {
+      const double seconds = RunBench(depth, threads, mode);
+      if (seconds > 0.0) {
+        std::cout << ", time to depth speedup: " << single_thread_seconds / seconds;
+      }
+      std::cout << std::endl;
+    }
+  }
+  return 0;
+}
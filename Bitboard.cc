@@ -0,0 +1,242 @@
+#include "Bitboard.h"
+
+
+namespace {
+
+constexpr int DirectionSteps[DIRECTIONS][2] = {
+  {0, 1}, {1, 1}, {1, 0}, {1, -1}, {0, -1}, {-1, -1}, {-1, 0}, {-1, 1}
+};
+
+constexpr int KnightSteps[8][2] = {
+  {1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}
+};
+
+constexpr bool IsOnBoard(int x, int y) {
+  return x >= 0 && x < 8 && y >= 0 && y < 8;
+}
+
+#ifdef _MAILBOX_ATTACKS_
+
+// 10x12 mailbox: the board surrounded by one file on each side and two ranks
+// above and below, so that no ray step from a board square can leave the
+// array. Off-board cells hold -1, which is all the walks check.
+struct Mailbox {
+  constexpr Mailbox() : cells(), squares() {
+    for (int i = 0; i < 120; ++i) {
+      cells[i] = -1;
+    }
+    for (int y = 0; y < 8; ++y) {
+      for (int x = 0; x < 8; ++x) {
+        cells[(y + 2) * 10 + x + 1] = y * 8 + x;
+        squares[y * 8 + x] = (y + 2) * 10 + x + 1;
+      }
+    }
+  }
+
+  int cells[120];
+  int squares[64];
+};
+
+constexpr Mailbox Mailbox10x12;
+
+const int BishopSteps[4] = {-11, -9, 9, 11};
+const int RookSteps[4] = {-10, -1, 1, 10};
+
+Bitboard SliderAttacks(size_t square, Bitboard occupancy, const int (&steps)[4]) {
+  const int from = Mailbox10x12.squares[square];
+  Bitboard result = 0u;
+  for (const int step: steps) {
+    for (int cell = from + step; Mailbox10x12.cells[cell] >= 0; cell += step) {
+      const Bitboard bit = SquareBit(Mailbox10x12.cells[cell]);
+      result |= bit;
+      if (bit & occupancy) {
+        break;
+      }
+    }
+  }
+  return result;
+}
+
+#else
+
+// Ray up to and including the first blocker: squares behind the blocker are
+// cut off with the blocker's own ray in the same direction.
+Bitboard RayAttacks(Direction direction, size_t square, Bitboard occupancy) {
+  const Bitboard ray = Ray(direction, square);
+  const Bitboard blockers = ray & occupancy;
+  if (!blockers) {
+    return ray;
+  }
+  const bool towards_higher_squares =
+    direction == NORTH || direction == NORTH_EAST || direction == EAST || direction == NORTH_WEST;
+  const size_t blocker = towards_higher_squares ? LowestSquare(blockers) : 63u - __builtin_clzll(blockers);
+  return ray ^ Ray(direction, blocker);
+}
+
+Bitboard SlowRookAttacks(size_t square, Bitboard occupancy) {
+  return RayAttacks(NORTH, square, occupancy) | RayAttacks(EAST, square, occupancy) |
+         RayAttacks(SOUTH, square, occupancy) | RayAttacks(WEST, square, occupancy);
+}
+
+Bitboard SlowBishopAttacks(size_t square, Bitboard occupancy) {
+  return RayAttacks(NORTH_EAST, square, occupancy) | RayAttacks(SOUTH_EAST, square, occupancy) |
+         RayAttacks(SOUTH_WEST, square, occupancy) | RayAttacks(NORTH_WEST, square, occupancy);
+}
+
+#endif  // _MAILBOX_ATTACKS_
+
+}  // unnamed namespace
+
+
+CpuFeatures::CpuFeatures() {
+#ifdef __x86_64__
+  __builtin_cpu_init();
+  popcnt = __builtin_cpu_supports("popcnt");
+  bmi2 = __builtin_cpu_supports("bmi2") &&
+         !__builtin_cpu_is("znver1") && !__builtin_cpu_is("znver2");
+#endif
+}
+
+// Has to be initialized before Magics, which depend on it.
+const CpuFeatures Cpu;
+
+constexpr AttackTables::AttackTables()
+  : knight(), king(), pawn(), rays(), between(), line() {
+  for (int y = 0; y < 8; ++y) {
+    for (int x = 0; x < 8; ++x) {
+      const size_t square = SquareIndex(x, y);
+      for (const auto& step: KnightSteps) {
+        if (IsOnBoard(x + step[0], y + step[1])) {
+          knight[square] |= SquareBit(x + step[0], y + step[1]);
+        }
+      }
+      for (int direction = 0; direction < DIRECTIONS; ++direction) {
+        const int dx = DirectionSteps[direction][0];
+        const int dy = DirectionSteps[direction][1];
+        if (IsOnBoard(x + dx, y + dy)) {
+          king[square] |= SquareBit(x + dx, y + dy);
+        }
+        for (int nx = x + dx, ny = y + dy; IsOnBoard(nx, ny); nx += dx, ny += dy) {
+          rays[direction][square] |= SquareBit(nx, ny);
+        }
+      }
+      for (int dx = -1; dx <= 1; dx += 2) {
+        if (IsOnBoard(x + dx, y + 1)) {
+          pawn[true][square] |= SquareBit(x + dx, y + 1);
+        }
+        if (IsOnBoard(x + dx, y - 1)) {
+          pawn[false][square] |= SquareBit(x + dx, y - 1);
+        }
+      }
+    }
+  }
+  for (int y = 0; y < 8; ++y) {
+    for (int x = 0; x < 8; ++x) {
+      const size_t square = SquareIndex(x, y);
+      for (int direction = 0; direction < DIRECTIONS; ++direction) {
+        const int dx = DirectionSteps[direction][0];
+        const int dy = DirectionSteps[direction][1];
+        const Bitboard whole_line = rays[direction][square] |
+                                    rays[(direction + 4) % DIRECTIONS][square] |
+                                    SquareBit(square);
+        Bitboard passed = 0u;
+        for (int nx = x + dx, ny = y + dy; IsOnBoard(nx, ny); nx += dx, ny += dy) {
+          between[square][SquareIndex(nx, ny)] = passed;
+          line[square][SquareIndex(nx, ny)] = whole_line;
+          passed |= SquareBit(nx, ny);
+        }
+      }
+    }
+  }
+}
+
+constexpr AttackTables Tables;
+
+#ifdef _MAILBOX_ATTACKS_
+
+Bitboard BishopAttacks(size_t square, Bitboard occupancy) {
+  return SliderAttacks(square, occupancy, BishopSteps);
+}
+
+Bitboard RookAttacks(size_t square, Bitboard occupancy) {
+  return SliderAttacks(square, occupancy, RookSteps);
+}
+
+#else
+
+MagicTables::MagicTables() {
+  InitMagics(rook, rook_attacks, SlowRookAttacks);
+  InitMagics(bishop, bishop_attacks, SlowBishopAttacks);
+}
+
+void MagicTables::InitMagics(Magic (&magics)[64], Bitboard* table,
+                             Bitboard (*attacks)(size_t, Bitboard)) {
+  // xorshift64* is reseeded for every square with a per-rank seed known to
+  // find magics after few attempts, which keeps the startup time low.
+  const uint64_t seeds[8] = {728, 10316, 55013, 32803, 12281, 15100, 16645, 255};
+  uint64_t state = 0u;
+  auto Next = [&state]() -> uint64_t {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545f4914f6cdd1dull;
+  };
+  // Entries filled in the current attempt carry its number, which saves
+  // clearing the table between attempts.
+  unsigned epochs[4096] = {};
+  unsigned attempt = 0u;
+  Bitboard occupancies[4096];
+  Bitboard references[4096];
+
+  for (size_t square = 0; square < 64u; ++square) {
+    state = seeds[square / 8u];
+    // Edge squares never hide anything behind them, so they're left out of
+    // the mask unless the slider stands on that edge.
+    const Bitboard edges = ((RANK_1 | RANK_8) & ~(RANK_1 << (square / 8u * 8u))) |
+                           ((FILE_A | FILE_H) & ~(FILE_A << (square % 8u)));
+    Magic& magic = magics[square];
+    magic.mask = attacks(square, 0u) & ~edges;
+    magic.shift = 64u - PopCount(magic.mask);
+    magic.attacks = table;
+
+    // Every subset of the mask, enumerated with the carry-rippler trick.
+    size_t size = 0u;
+    Bitboard occupancy = 0u;
+    do {
+      occupancies[size] = occupancy;
+      references[size] = attacks(square, occupancy);
+      ++size;
+      occupancy = (occupancy - magic.mask) & magic.mask;
+    } while (occupancy);
+    table += size;
+
+#ifdef __x86_64__
+    if (Cpu.bmi2) {
+      for (size_t i = 0u; i < size; ++i) {
+        magic.attacks[Pext(occupancies[i], magic.mask)] = references[i];
+      }
+      continue;
+    }
+#endif
+
+    for (size_t i = 0u; i < size; ) {
+      do {
+        magic.magic = Next() & Next() & Next();
+      } while (PopCount((magic.mask * magic.magic) >> 56) < 6u);
+      ++attempt;
+      for (i = 0u; i < size; ++i) {
+        const size_t index = magic.Index(occupancies[i]);
+        if (epochs[index] < attempt) {
+          epochs[index] = attempt;
+          magic.attacks[index] = references[i];
+        } else if (magic.attacks[index] != references[i]) {
+          break;
+        }
+      }
+    }
+  }
+}
+
+const MagicTables Magics;
+
+#endif  // _MAILBOX_ATTACKS_
@@ -0,0 +1,209 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+// One bit per square; bit index is y * 8 + x, so a1 is bit 0 and h8 is bit 63.
+using Bitboard = uint64_t;
+
+enum FigureType {
+  PAWN,
+  KNIGHT,
+  BISHOP,
+  ROOK,
+  QUEEN,
+  KING,
+  FIGURE_TYPES
+};
+
+const Bitboard FILE_A = 0x0101010101010101ull;
+const Bitboard FILE_H = FILE_A << 7;
+const Bitboard RANK_1 = 0xffull;
+const Bitboard RANK_8 = RANK_1 << 56;
+
+constexpr size_t SquareIndex(size_t x, size_t y) {
+  return y * 8u + x;
+}
+
+constexpr Bitboard SquareBit(size_t index) {
+  return Bitboard(1) << index;
+}
+
+constexpr Bitboard SquareBit(size_t x, size_t y) {
+  return SquareBit(SquareIndex(x, y));
+}
+
+// Instruction set extensions of the host, detected once at startup. Hot
+// bitboard routines test them on every call; the branch always goes the
+// same way, so one binary runs at full speed on old and new hosts alike.
+struct CpuFeatures {
+  CpuFeatures();
+
+  bool popcnt{false};
+  // Only set where PEXT is fast; early AMD Zen cores microcode it.
+  bool bmi2{false};
+};
+
+extern const CpuFeatures Cpu;
+
+inline unsigned PopCount(Bitboard b) {
+#ifdef __x86_64__
+  // Instructions are written in assembly, so that the code calling them
+  // doesn't have to be compiled for the extension.
+  if (Cpu.popcnt) {
+    Bitboard count;
+    asm("popcntq %1, %0" : "=r"(count) : "r"(b));
+    return count;
+  }
+#endif
+  return __builtin_popcountll(b);
+}
+
+#ifdef __x86_64__
+// Mustn't be called unless Cpu.bmi2 is set.
+inline Bitboard Pext(Bitboard b, Bitboard mask) {
+  Bitboard result;
+  asm("pextq %2, %1, %0" : "=r"(result) : "r"(b), "r"(mask));
+  return result;
+}
+#endif
+
+inline size_t LowestSquare(Bitboard b) {
+  assert(b);
+  return __builtin_ctzll(b);
+}
+
+inline size_t PopLowestSquare(Bitboard& b) {
+  const size_t index = LowestSquare(b);
+  b &= b - 1;
+  return index;
+}
+
+enum Direction {
+  NORTH,
+  NORTH_EAST,
+  EAST,
+  SOUTH_EAST,
+  SOUTH,
+  SOUTH_WEST,
+  WEST,
+  NORTH_WEST,
+  DIRECTIONS
+};
+
+// Attack and geometry masks, evaluated at compile time in Bitboard.cc.
+struct AttackTables {
+  constexpr AttackTables();
+
+  Bitboard knight[64];
+  Bitboard king[64];
+  // Indexed by [white][square].
+  Bitboard pawn[2][64];
+  // Squares from given square (exclusive) to the edge of the board.
+  Bitboard rays[DIRECTIONS][64];
+  Bitboard between[64][64];
+  Bitboard line[64][64];
+};
+
+extern const AttackTables Tables;
+
+inline Bitboard KnightAttacks(size_t square) {
+  return Tables.knight[square];
+}
+
+inline Bitboard KingAttacks(size_t square) {
+  return Tables.king[square];
+}
+
+template <bool White>
+inline Bitboard PawnAttacks(size_t square) {
+  return Tables.pawn[White][square];
+}
+
+inline Bitboard PawnAttacks(bool white, size_t square) {
+  return Tables.pawn[white][square];
+}
+
+inline Bitboard Ray(Direction direction, size_t square) {
+  return Tables.rays[direction][square];
+}
+
+// Squares strictly between two squares lying on common rank, file or
+// diagonal; empty set for other pairs.
+inline Bitboard SquaresBetween(size_t square1, size_t square2) {
+  return Tables.between[square1][square2];
+}
+
+// Whole rank, file or diagonal containing both squares; empty set if
+// they don't share one.
+inline Bitboard LineThrough(size_t square1, size_t square2) {
+  return Tables.line[square1][square2];
+}
+
+#ifdef _MAILBOX_ATTACKS_
+
+Bitboard BishopAttacks(size_t square, Bitboard occupancy);
+Bitboard RookAttacks(size_t square, Bitboard occupancy);
+
+#else
+
+// Slider attacks for every relevant occupancy of a square, indexed by
+// multiplying the occupancy with a magic number and keeping the top bits,
+// or by extracting the masked bits with PEXT where it's available.
+struct Magic {
+  size_t Index(Bitboard occupancy) const {
+#ifdef __x86_64__
+    if (Cpu.bmi2) {
+      return Pext(occupancy, mask);
+    }
+#endif
+    return ((occupancy & mask) * magic) >> shift;
+  }
+
+  Bitboard mask;
+  Bitboard magic;
+  Bitboard* attacks;
+  unsigned shift;
+};
+
+// Magic numbers are searched for (unless PEXT is used) and the tables filled
+// when the program starts, in Bitboard.cc.
+class MagicTables {
+ public:
+  MagicTables();
+
+  Magic rook[64];
+  Magic bishop[64];
+
+ private:
+  static const size_t ROOK_ATTACKS_SIZE = 0x19000;
+  static const size_t BISHOP_ATTACKS_SIZE = 0x1480;
+
+  static void InitMagics(Magic (&magics)[64], Bitboard* table,
+                         Bitboard (*attacks)(size_t, Bitboard));
+
+  Bitboard rook_attacks[ROOK_ATTACKS_SIZE];
+  Bitboard bishop_attacks[BISHOP_ATTACKS_SIZE];
+};
+
+extern const MagicTables Magics;
+
+inline Bitboard BishopAttacks(size_t square, Bitboard occupancy) {
+  const Magic& magic = Magics.bishop[square];
+  return magic.attacks[magic.Index(occupancy)];
+}
+
+inline Bitboard RookAttacks(size_t square, Bitboard occupancy) {
+  const Magic& magic = Magics.rook[square];
+  return magic.attacks[magic.Index(occupancy)];
+}
+
+#endif  // _MAILBOX_ATTACKS_
+
+inline Bitboard QueenAttacks(size_t square, Bitboard occupancy) {
+  return BishopAttacks(square, occupancy) | RookAttacks(square, occupancy);
+}
+
+#endif  // BITBOARD_H
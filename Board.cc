@@ -1,8 +1,65 @@
 #include "Board.h"
 
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
 #include "utils/Utils.h"
 
 
+namespace {
+
+struct ZobristKeys {
+  ZobristKeys() {
+    // xorshift64* with a fixed seed, so keys are the same in every run.
+    uint64_t state = 0x9e3779b97f4a7c15ull;
+    auto Next = [&state]() -> uint64_t {
+      state ^= state >> 12;
+      state ^= state << 25;
+      state ^= state >> 27;
+      return state * 0x2545f4914f6cdd1dull;
+    };
+    for (auto& colors: figures) {
+      for (auto& squares: colors) {
+        for (uint64_t& key: squares) {
+          key = Next();
+        }
+      }
+    }
+    for (uint64_t& key: castlings) {
+      key = Next();
+    }
+    for (uint64_t& key: en_passant_file) {
+      key = Next();
+    }
+    white_to_move = Next();
+  }
+
+  uint64_t figures[2][FIGURE_TYPES][64];
+  uint64_t castlings[static_cast<size_t>(Castling::LAST)];
+  uint64_t en_passant_file[8];
+  uint64_t white_to_move;
+};
+
+const ZobristKeys Zobrist;
+
+// Figures of any color standing alone between given square and a slider
+// which would otherwise attack it.
+Bitboard SliderBlockers(size_t square, Bitboard bishops, Bitboard rooks, Bitboard occupancy) {
+  Bitboard result = 0u;
+  Bitboard snipers = (BishopAttacks(square, 0u) & bishops) | (RookAttacks(square, 0u) & rooks);
+  while (snipers) {
+    const Bitboard blockers = SquaresBetween(square, PopLowestSquare(snipers)) & occupancy;
+    if (PopCount(blockers) == 1u) {
+      result |= blockers;
+    }
+  }
+  return result;
+}
+
+}  // unnamed namespace
+
+
 Square::Square(const std::string& square) {
   x = square[0] - 'a';
   y = square[1] - '1';
@@ -31,11 +88,15 @@ std::ostream& operator<<(std::ostream& os, const Square& square) {
 }
 
 bool operator==(const Board& b1, const Board& b2) {
-  for (size_t x = 0; x < 8u; ++x) {
-    for (size_t y = 0; y < 8u; ++y) {
-      if (b1.at(x, y) != b2.at(x, y)) {
-        return false;
-      }
+  // Unequal positions almost always differ in hash; remaining comparisons
+  // only guard against collisions.
+  if (b1.Hash() != b2.Hash()) {
+    return false;
+  }
+  for (size_t type = 0; type < FIGURE_TYPES; ++type) {
+    if (b1.Figures(true, static_cast<FigureType>(type)) != b2.Figures(true, static_cast<FigureType>(type)) ||
+        b1.Figures(false, static_cast<FigureType>(type)) != b2.Figures(false, static_cast<FigureType>(type))) {
+      return false;
     }
   }
   return b1.WhiteToMove() == b2.WhiteToMove() &&
@@ -55,6 +116,60 @@ Board::Board(const std::string& fen) {
   index = HandleEnPassantTargetSquare(fen, index);
   index = HandleHalfMoveClock(fen, index);
   HandleFullMoveNumber(fen, index);
+  hash_ = CalculateHash();
+}
+
+uint64_t Board::CalculateHash() const {
+  uint64_t hash = 0u;
+  for (size_t white = 0; white < 2; ++white) {
+    for (size_t type = 0; type < FIGURE_TYPES; ++type) {
+      Bitboard figures = figures_[white][type];
+      while (figures) {
+        hash ^= Zobrist.figures[white][type][PopLowestSquare(figures)];
+      }
+    }
+  }
+  for (size_t c = 0; c < static_cast<size_t>(Castling::LAST); ++c) {
+    if (castlings_[c]) {
+      hash ^= Zobrist.castlings[c];
+    }
+  }
+  if (!en_passant_target_square_.IsInvalid()) {
+    hash ^= Zobrist.en_passant_file[en_passant_target_square_.x];
+  }
+  if (white_to_move_) {
+    hash ^= Zobrist.white_to_move;
+  }
+  return hash;
+}
+
+void Board::ChangeSideToMove() {
+  white_to_move_ = !white_to_move_;
+  hash_ ^= Zobrist.white_to_move;
+  check_info_valid_ = false;
+}
+
+void Board::UnsetCanCastle(Castling c) {
+  if (castlings_[static_cast<size_t>(c)]) {
+    castlings_[static_cast<size_t>(c)] = false;
+    hash_ ^= Zobrist.castlings[static_cast<size_t>(c)];
+  }
+}
+
+void Board::SetEnPassantTargetSquare(Square s) {
+  InvalidateEnPassantTargetSquare();
+  if (s.IsInvalid()) {
+    return;
+  }
+  en_passant_target_square_ = s;
+  hash_ ^= Zobrist.en_passant_file[s.x];
+}
+
+void Board::InvalidateEnPassantTargetSquare() {
+  if (!en_passant_target_square_.IsInvalid()) {
+    hash_ ^= Zobrist.en_passant_file[en_passant_target_square_.x];
+    en_passant_target_square_.Invalidate();
+  }
 }
 
 void Board::HandleFullMoveNumber(const std::string& fen, size_t index) {
@@ -151,9 +266,6 @@ size_t Board::HandleSideToMove(const std::string& fen, size_t index) {
 }
 
 size_t Board::HandleFields(const std::string& fen) {
-  std::array<char, 8> rank;
-  rank.fill('\0');
-  squares_.fill(rank);
   size_t current_index = 0u;
   for (size_t i = 0; i < 8; ++i) {
     char separator = '/';
@@ -168,10 +280,10 @@ size_t Board::HandleFields(const std::string& fen) {
     HandleSingleRank(fen, single_rank, 7 - i);
     current_index = new_index + 1;
   }
-  if (white_king_position_.IsInvalid()) {
+  if (!figures_[true][KING]) {
     throw InvalidFENException(fen, "No white king found");
   }
-  if (black_king_position_.IsInvalid()) {
+  if (!figures_[false][KING]) {
     throw InvalidFENException(fen, "No black king found");
   }
   return current_index;
@@ -183,24 +295,17 @@ void Board::HandleSingleRank(const std::string& fen, const std::string& rank_str
   }
   unsigned file = 0u;
   for(const char c: rank_str) {
+    const Piece piece = PieceFromChar(c);
     if (c >= '1' && c <= '8') {
       file += c - '0';
-    } else if (c == 'q' || c == 'Q' || c == 'K' || c == 'k' || c == 'N' || c == 'n' ||
-               c == 'R' || c == 'r' || c == 'B' || c == 'b' || c == 'P' || c == 'p') {
-      squares_[file][rank] = c;
-      if (c == 'K') {
-        if (!white_king_position_.IsInvalid()) {
-          throw InvalidFENException(fen, "Found two white kings");
-        }
-        white_king_position_.x = file;
-        white_king_position_.y = rank;
-      } else if (c == 'k') {
-        if (!black_king_position_.IsInvalid()) {
-          throw InvalidFENException(fen, "Found two black kings");
-        }
-        black_king_position_.x = file;
-        black_king_position_.y = rank;
+    } else if (piece != NO_PIECE) {
+      if (file > 7) {
+        throw InvalidFENException(fen, "Invalid one subsection of piece placement section");
       }
+      if (TypeOf(piece) == KING && figures_[IsWhite(piece)][KING]) {
+        throw InvalidFENException(fen, IsWhite(piece) ? "Found two white kings" : "Found two black kings");
+      }
+      SetPiece(SquareIndex(file, rank), piece);
       ++file;
     } else {
       throw InvalidFENException(fen, "Invalid char in piece placement section");
@@ -214,96 +319,225 @@ void Board::HandleSingleRank(const std::string& fen, const std::string& rank_str
   }
 }
 
-void Board::SetKingPosition(bool white, size_t x, size_t y) {
-  if (white) {
-    white_king_position_.x = x;
-    white_king_position_.y = y;
-  } else {
-    black_king_position_.x = x;
-    black_king_position_.y = y;
+void Board::SetFigure(size_t x, size_t y, char figure) {
+  SetPiece(SquareIndex(x, y), PieceFromChar(figure));
+}
+
+void Board::SetPiece(size_t square, Piece piece) {
+  const Bitboard bit = SquareBit(square);
+  const Piece old_piece = squares_[square];
+  check_info_valid_ = false;
+  if (old_piece != NO_PIECE) {
+    figures_[IsWhite(old_piece)][TypeOf(old_piece)] &= ~bit;
+    occupancy_[IsWhite(old_piece)] &= ~bit;
+    hash_ ^= Zobrist.figures[IsWhite(old_piece)][TypeOf(old_piece)][square];
+  }
+  squares_[square] = piece;
+  if (piece != NO_PIECE) {
+    figures_[IsWhite(piece)][TypeOf(piece)] |= bit;
+    occupancy_[IsWhite(piece)] |= bit;
+    hash_ ^= Zobrist.figures[IsWhite(piece)][TypeOf(piece)][square];
   }
 }
 
-bool Board::IsKingInCheckHelper(const Square& starting_square, bool white, int x_offset, int y_offset) const {
-  const bool is_diagonal = x_offset != 0 && y_offset != 0;
-  int x = static_cast<int>(starting_square.x);
-  int y = static_cast<int>(starting_square.y);
-  bool first_iteration = true;
-  while (1) {
-    x += x_offset;
-    y += y_offset;
-    if (x < 0 || x > 7 || y < 0 || y > 7) {
-      return false;
-    }
-    char figure = squares_[x][y];
-    if (figure == '\0') {
-      first_iteration = false;
-      continue;
-    }
-    if (white) {
-      if (first_iteration && figure == 'k') {
-        return true;
-      }
-      if (is_diagonal) {
-        return figure == 'q' || figure == 'b';
-      } else {
-        return figure == 'q' || figure == 'r';
-      }
-    } else {
-      if (first_iteration && figure == 'K') {
-        return true;
-      }
-      if (is_diagonal) {
-        return figure == 'Q' || figure == 'B';
-      } else {
-        return figure == 'Q' || figure == 'R';
-      }
+UndoInfo Board::MakeMove(Move move) {
+  const size_t from = move.From();
+  const size_t to = move.To();
+  const Piece piece = squares_[from];
+  const bool white = white_to_move_;
+  assert(piece != NO_PIECE && IsWhite(piece) == white);
+  UndoInfo undo;
+  undo.captured_piece = squares_[to];
+  std::copy(std::begin(castlings_), std::end(castlings_), std::begin(undo.castlings));
+  undo.en_passant_target_square = en_passant_target_square_;
+  undo.halfmove_clock = halfmove_clock_;
+  undo.hash = hash_;
+
+  SetPiece(from, NO_PIECE);
+  SetPiece(to, move.IsPromotion() ? MakePiece(white, move.PromotionFigure()) : piece);
+  if (move.IsEnPassant()) {
+    undo.captured_piece = MakePiece(!white, PAWN);
+    SetPiece(SquareIndex(move.NewX(), move.OldY()), NO_PIECE);
+  } else if (move.IsCastling()) {
+    const bool king_side = move.GetFlags() == Move::KING_SIDE_CASTLING;
+    SetPiece(king_side ? from + 3u : from - 4u, NO_PIECE);
+    SetPiece(king_side ? from + 1u : from - 1u, MakePiece(white, ROOK));
+  }
+
+  const FigureType type = TypeOf(piece);
+  if (type == KING) {
+    UnsetCanCastle(white ? Castling::K : Castling::k);
+    UnsetCanCastle(white ? Castling::Q : Castling::q);
+  }
+  // Rook leaving or being captured on its initial square.
+  auto UpdateCastlingsForRookSquare = [this](size_t square) {
+    if (square == 0u) {
+      UnsetCanCastle(Castling::Q);
+    } else if (square == 7u) {
+      UnsetCanCastle(Castling::K);
+    } else if (square == 56u) {
+      UnsetCanCastle(Castling::q);
+    } else if (square == 63u) {
+      UnsetCanCastle(Castling::k);
     }
-    first_iteration = false;
+  };
+  UpdateCastlingsForRookSquare(from);
+  UpdateCastlingsForRookSquare(to);
+
+  if (move.IsDoublePawnPush()) {
+    SetEnPassantTargetSquare(Square(move.OldX(), (move.OldY() + move.NewY()) / 2u));
+  } else {
+    InvalidateEnPassantTargetSquare();
   }
-  return false;
+  if (type == PAWN || undo.captured_piece != NO_PIECE) {
+    ResetHalfMoveClock();
+  } else {
+    IncrementHalfMoveClock();
+  }
+  if (!white) {
+    IncrementFullMoveNumber();
+  }
+  ChangeSideToMove();
+  return undo;
+}
+
+void Board::UnmakeMove(Move move, const UndoInfo& undo) {
+  const size_t from = move.From();
+  const size_t to = move.To();
+  const bool white = !white_to_move_;
+  SetPiece(from, move.IsPromotion() ? MakePiece(white, PAWN) : squares_[to]);
+  if (move.IsEnPassant()) {
+    SetPiece(to, NO_PIECE);
+    SetPiece(SquareIndex(move.NewX(), move.OldY()), undo.captured_piece);
+  } else {
+    SetPiece(to, undo.captured_piece);
+  }
+  if (move.IsCastling()) {
+    const bool king_side = move.GetFlags() == Move::KING_SIDE_CASTLING;
+    SetPiece(king_side ? from + 1u : from - 1u, NO_PIECE);
+    SetPiece(king_side ? from + 3u : from - 4u, MakePiece(white, ROOK));
+  }
+  std::copy(std::begin(undo.castlings), std::end(undo.castlings), std::begin(castlings_));
+  en_passant_target_square_ = undo.en_passant_target_square;
+  halfmove_clock_ = undo.halfmove_clock;
+  if (!white) {
+    --fullmove_number_;
+  }
+  white_to_move_ = white;
+  hash_ = undo.hash;
+  check_info_valid_ = false;
+}
+
+Board Board::BoardAfterMove(Move move) const {
+  Board copy = *this;
+  copy.MakeMove(move);
+  return copy;
+}
+
+bool Board::IsSquareAttacked(size_t square, bool by_white) const {
+  return by_white ? IsSquareAttacked<true>(square) : IsSquareAttacked<false>(square);
+}
+
+Bitboard Board::AttackersTo(size_t square, bool by_white, Bitboard occupancy) const {
+  return by_white ? AttackersTo<true>(square, occupancy) : AttackersTo<false>(square, occupancy);
 }
 
 bool Board::IsKingInCheck(bool white) const {
-  const Square& starting_square = white ? white_king_position_ : black_king_position_;
-  // First check straight lines.
-  if (IsKingInCheckHelper(starting_square, white, 0, 1)) return true;
-  if (IsKingInCheckHelper(starting_square, white, 1, 0)) return true;
-  if (IsKingInCheckHelper(starting_square, white, 0, -1)) return true;
-  if (IsKingInCheckHelper(starting_square, white, -1, 0)) return true;
-  // Now check diagonals.
-  if (IsKingInCheckHelper(starting_square, white, 1, 1)) return true;
-  if (IsKingInCheckHelper(starting_square, white, 1, -1)) return true;
-  if (IsKingInCheckHelper(starting_square, white, -1, 1)) return true;
-  if (IsKingInCheckHelper(starting_square, white, -1, -1)) return true;
-  // Check for checks by knight.
-  int x = starting_square.x;
-  int y = starting_square.y;
-  char knight = white ? 'n' : 'N';
-  if (IsFigureAtGivenCoordinates(x + 2, y + 1, knight)) return true;
-  if (IsFigureAtGivenCoordinates(x + 2, y - 1, knight)) return true;
-  if (IsFigureAtGivenCoordinates(x + 1, y - 2, knight)) return true;
-  if (IsFigureAtGivenCoordinates(x - 1, y - 2, knight)) return true;
-  if (IsFigureAtGivenCoordinates(x - 2, y + 1, knight)) return true;
-  if (IsFigureAtGivenCoordinates(x - 2, y - 1, knight)) return true;
-  if (IsFigureAtGivenCoordinates(x + 1, y + 2, knight)) return true;
-  if (IsFigureAtGivenCoordinates(x - 1, y + 2, knight)) return true;
-  // Now it's time for pawns.
-  char pawn = white ? 'p' : 'P';
-  int offset = white ? 1 : -1;
-  if (IsFigureAtGivenCoordinates(x + 1, y + offset, pawn)) return true;
-  if (IsFigureAtGivenCoordinates(x - 1, y + offset, pawn)) return true;
+  if (white == white_to_move_) {
+    return GetCheckInfo().checkers != 0u;
+  }
+  return white ? IsKingInCheck<true>() : IsKingInCheck<false>();
+}
+
+void Board::CalculateCheckInfo() const {
+  if (white_to_move_) {
+    CalculateCheckInfo<true>();
+  } else {
+    CalculateCheckInfo<false>();
+  }
+}
+
+template <bool White>
+void Board::CalculateCheckInfo() const {
+  const auto& own = figures_[White];
+  const auto& opponent = figures_[!White];
+  const Bitboard occupancy = Occupancy();
+  const size_t opponent_king_square = LowestSquare(opponent[KING]);
+  check_info_.king_square = LowestSquare(own[KING]);
+  check_info_.checkers = AttackersTo<!White>(check_info_.king_square, occupancy);
+  check_info_.pinned =
+    SliderBlockers(check_info_.king_square, opponent[BISHOP] | opponent[QUEEN],
+                   opponent[ROOK] | opponent[QUEEN], occupancy) & occupancy_[White];
+  check_info_.discoverers =
+    SliderBlockers(opponent_king_square, own[BISHOP] | own[QUEEN],
+                   own[ROOK] | own[QUEEN], occupancy) & occupancy_[White];
+  Bitboard* check_squares = check_info_.check_squares;
+  check_squares[PAWN] = PawnAttacks<!White>(opponent_king_square);
+  check_squares[KNIGHT] = KnightAttacks(opponent_king_square);
+  check_squares[BISHOP] = BishopAttacks(opponent_king_square, occupancy);
+  check_squares[ROOK] = RookAttacks(opponent_king_square, occupancy);
+  check_squares[QUEEN] = check_squares[BISHOP] | check_squares[ROOK];
+  check_squares[KING] = 0u;
+  check_info_valid_ = true;
+}
+
+bool Board::GivesCheck(Move move) const {
+  const CheckInfo& info = GetCheckInfo();
+  const size_t from = move.From();
+  const size_t to = move.To();
+  const bool white = white_to_move_;
+  const size_t opponent_king_square = LowestSquare(figures_[!white][KING]);
+  if (info.check_squares[TypeOf(squares_[from])] & SquareBit(to)) {
+    return true;
+  }
+  if ((info.discoverers & SquareBit(from)) &&
+      (move.IsCastling() || !(LineThrough(from, to) & SquareBit(opponent_king_square)))) {
+    return true;
+  }
+  const Bitboard occupancy = Occupancy() ^ SquareBit(from);
+  if (move.IsPromotion()) {
+    // The pawn may have been shielding the opponent's king from its own
+    // destination square.
+    const FigureType promoted = move.PromotionFigure();
+    if (!PieceIsSlider[MakePiece(white, promoted)]) {
+      return KnightAttacks(to) & SquareBit(opponent_king_square);
+    }
+    Bitboard attacks = 0u;
+    if (promoted != ROOK) {
+      attacks |= BishopAttacks(to, occupancy);
+    }
+    if (promoted != BISHOP) {
+      attacks |= RookAttacks(to, occupancy);
+    }
+    return attacks & SquareBit(opponent_king_square);
+  }
+  if (move.IsEnPassant()) {
+    // Both pawns leave their squares at once, which may uncover a slider.
+    const size_t captured = SquareIndex(move.NewX(), move.OldY());
+    const Bitboard after = (occupancy ^ SquareBit(captured)) | SquareBit(to);
+    const auto& own = figures_[white];
+    return (BishopAttacks(opponent_king_square, after) & (own[BISHOP] | own[QUEEN])) ||
+           (RookAttacks(opponent_king_square, after) & (own[ROOK] | own[QUEEN]));
+  }
+  if (move.IsCastling()) {
+    const bool king_side = move.GetFlags() == Move::KING_SIDE_CASTLING;
+    const size_t rook_from = king_side ? from + 3u : from - 4u;
+    const size_t rook_to = king_side ? from + 1u : from - 1u;
+    const Bitboard after = (occupancy ^ SquareBit(rook_from)) | SquareBit(to) | SquareBit(rook_to);
+    return RookAttacks(rook_to, after) & SquareBit(opponent_king_square);
+  }
   return false;
 }
 
-bool Board::IsFigureAtGivenCoordinates(int x, int y, char figure) const {
-  return x >= 0 && x <= 7 && y >= 0 && y <=7 && squares_[x][y] == figure;
+char Board::at(size_t x, size_t y) const {
+  return PieceChars[squares_[SquareIndex(x, y)]];
 }
 
 char Board::at(const char* square) const {
-  return squares_[square[0] - 'a'][square[1] - '1'];
+  return at(square[0] - 'a', square[1] - '1');
 }
 
 Square Board::KingPosition(bool white) const {
-  return white ? white_king_position_ : black_king_position_;
+  const size_t square = LowestSquare(figures_[white][KING]);
+  return Square(square % 8u, square / 8u);
 }
@@ -2,9 +2,14 @@
 #define BOARD_H
 
 #include <array>
+#include <cstdint>
 #include <iostream>
 #include <string>
 
+#include "Bitboard.h"
+#include "Move.h"
+#include "Piece.h"
+
 struct InvalidFENException {
   InvalidFENException(const std::string& f, const std::string msg)
     : fen(f), error_message(msg) {}
@@ -42,6 +47,31 @@ struct Square {
 
 std::ostream& operator<<(std::ostream& os, const Square& square);
 
+// State which can't be recovered from a move itself, saved by
+// Board::MakeMove() and needed by Board::UnmakeMove().
+struct UndoInfo {
+  Piece captured_piece;
+  bool castlings[static_cast<size_t>(Castling::LAST)];
+  Square en_passant_target_square;
+  unsigned short halfmove_clock;
+  uint64_t hash;
+};
+
+// Check related masks of a position, from the side to move's point of view.
+struct CheckInfo {
+  size_t king_square;
+  // Opponent's figures attacking own king.
+  Bitboard checkers;
+  // Own figures which can only move along the line between own king and
+  // an opponent's slider.
+  Bitboard pinned;
+  // Own figures standing between opponent's king and an own slider; moving
+  // them off that line gives a discovered check.
+  Bitboard discoverers;
+  // Squares from which a figure of given type would attack opponent's king.
+  Bitboard check_squares[FIGURE_TYPES];
+};
+
 class Board {
  public:
   Board(const std::string& fen);
@@ -49,25 +79,55 @@ class Board {
   Board(Board&& other) = default;
   Board& operator=(const Board& board) = default;
   bool IsKingInCheck(bool white) const;
-  char& at(size_t x, size_t y) { return squares_[x][y]; }
-  char at(size_t x, size_t y) const { return squares_[x][y]; }
+  // Calculated on first use and kept until the position changes.
+  const CheckInfo& GetCheckInfo() const {
+    if (!check_info_valid_) {
+      CalculateCheckInfo();
+    }
+    return check_info_;
+  }
+  // Tells whether a legal move of the side to move checks the opponent,
+  // without playing it.
+  bool GivesCheck(Move move) const;
+  bool IsSquareAttacked(size_t square, bool by_white) const;
+  // Figures of given color attacking the square, with sliders seeing
+  // through the board as if it was occupied by given set.
+  Bitboard AttackersTo(size_t square, bool by_white, Bitboard occupancy) const;
+  // Variants with color known at compile time, for move generation.
+  template <bool White> bool IsKingInCheck() const;
+  template <bool ByWhite> bool IsSquareAttacked(size_t square) const;
+  template <bool ByWhite> Bitboard AttackersTo(size_t square, Bitboard occupancy) const;
+  // Figure on given square, '\0' if it's empty.
+  char at(size_t x, size_t y) const;
   char at(const char* square) const;
+  Piece PieceAt(size_t square) const { return squares_[square]; }
+  Bitboard Figures(bool white, FigureType type) const { return figures_[white][type]; }
+  Bitboard Occupancy(bool white) const { return occupancy_[white]; }
+  Bitboard Occupancy() const { return occupancy_[false] | occupancy_[true]; }
+  void SetFigure(size_t x, size_t y, char figure);
+  void SetPiece(size_t square, Piece piece);
   bool CanCastle(Castling c) const { return castlings_[static_cast<size_t>(c)]; }
   Square EnPassantTargetSquare() const { return en_passant_target_square_; }
   Square KingPosition(bool white) const;
   unsigned HalfMoveClock() const { return halfmove_clock_; }
   unsigned FullMoveNumber() const { return fullmove_number_; }
   bool WhiteToMove() const { return white_to_move_; }
-  void ChangeSideToMove() { white_to_move_ = !white_to_move_; }
+  // Zobrist key of piece placement, side to move, castling rights and
+  // en passant target square. Clocks are not part of it.
+  uint64_t Hash() const { return hash_; }
+  void ChangeSideToMove();
   void IncrementFullMoveNumber() { ++fullmove_number_; }
   void ResetHalfMoveClock() { halfmove_clock_ = 0u; }
   void IncrementHalfMoveClock() { ++halfmove_clock_; }
-  void UnsetCanCastle(Castling c) { castlings_[static_cast<size_t>(c)] = false; }
-  void SetEnPassantTargetSquare(Square s) { en_passant_target_square_ = s; }
-  void InvalidateEnPassantTargetSquare() { en_passant_target_square_.Invalidate(); }
+  void UnsetCanCastle(Castling c);
+  void SetEnPassantTargetSquare(Square s);
+  void InvalidateEnPassantTargetSquare();
+
+  // Plays a pseudo-legal move of the side to move in place.
+  UndoInfo MakeMove(Move move);
+  void UnmakeMove(Move move, const UndoInfo& undo);
+  Board BoardAfterMove(Move move) const;
 
-  void SetKingPosition(bool white, size_t x, size_t y);
- 
  private:
   size_t HandleFields(const std::string& fen);
   void HandleSingleRank(const std::string& fen, const std::string& rank_str, size_t rank);
@@ -76,19 +136,52 @@ class Board {
   size_t HandleEnPassantTargetSquare(const std::string& fen, size_t index);
   size_t HandleHalfMoveClock(const std::string& fen, size_t index);
   void HandleFullMoveNumber(const std::string& fen, size_t index);
-  bool IsKingInCheckHelper(const Square& starting_square, bool white, int x_offset, int y_offset) const;
-  bool IsFigureAtGivenCoordinates(int x, int y, char figure) const;
+  uint64_t CalculateHash() const;
+  void CalculateCheckInfo() const;
+  template <bool White> void CalculateCheckInfo() const;
 
-  std::array<std::array<char, 8>, 8> squares_;
+  // Indexed by [white][figure type]; black pieces are under index 0.
+  std::array<std::array<Bitboard, FIGURE_TYPES>, 2> figures_{};
+  std::array<Bitboard, 2> occupancy_{};
+  // Square-indexed copy of figures_ for constant time lookups.
+  std::array<Piece, 64> squares_{};
   bool white_to_move_;
   unsigned short halfmove_clock_;
   unsigned short fullmove_number_;
-  Square white_king_position_;
-  Square black_king_position_;
   Square en_passant_target_square_;
   bool castlings_[static_cast<size_t>(Castling::LAST)];
+  uint64_t hash_{0u};
+  mutable CheckInfo check_info_;
+  // Cleared by every change of the position.
+  mutable bool check_info_valid_{false};
 };
 
 bool operator==(const Board& b1, const Board& b2);
 
+template <bool White>
+bool Board::IsKingInCheck() const {
+  return IsSquareAttacked<!White>(LowestSquare(figures_[White][KING]));
+}
+
+template <bool ByWhite>
+bool Board::IsSquareAttacked(size_t square) const {
+  const auto& figures = figures_[ByWhite];
+  const Bitboard occupancy = Occupancy();
+  return (PawnAttacks<!ByWhite>(square) & figures[PAWN]) ||
+         (KnightAttacks(square) & figures[KNIGHT]) ||
+         (KingAttacks(square) & figures[KING]) ||
+         (BishopAttacks(square, occupancy) & (figures[BISHOP] | figures[QUEEN])) ||
+         (RookAttacks(square, occupancy) & (figures[ROOK] | figures[QUEEN]));
+}
+
+template <bool ByWhite>
+Bitboard Board::AttackersTo(size_t square, Bitboard occupancy) const {
+  const auto& figures = figures_[ByWhite];
+  return (PawnAttacks<!ByWhite>(square) & figures[PAWN]) |
+         (KnightAttacks(square) & figures[KNIGHT]) |
+         (KingAttacks(square) & figures[KING]) |
+         (BishopAttacks(square, occupancy) & (figures[BISHOP] | figures[QUEEN])) |
+         (RookAttacks(square, occupancy) & (figures[ROOK] | figures[QUEEN]));
+}
+
 #endif  // BOARD_H
@@ -10,6 +10,21 @@
 
 namespace {
 
+bool FiguresMatchBitboards(const Board& board) {
+  for (size_t square = 0; square < 64u; ++square) {
+    const Piece piece = board.PieceAt(square);
+    for (size_t type = 0; type < FIGURE_TYPES; ++type) {
+      for (const bool white: {true, false}) {
+        const bool on_bitboard = board.Figures(white, static_cast<FigureType>(type)) & SquareBit(square);
+        if (on_bitboard != (piece == MakePiece(white, static_cast<FigureType>(type)))) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
 TEST_PROCEDURE(Board_fen_constructor_valid_fens) {
   TEST_START
   {
@@ -34,7 +49,7 @@ TEST_PROCEDURE(Board_fen_constructor_valid_fens) {
     VERIFY_EQUALS(board.HalfMoveClock(), 0u);
     VERIFY_EQUALS(board.FullMoveNumber(), 1u);
     VERIFY_EQUALS(board.at(2, 6), 'p');
-    board.at(2, 6) = 'Q';
+    board.SetFigure(2, 6, 'Q');
     VERIFY_EQUALS(board.at(2, 6), 'Q');
   }
   {
@@ -218,4 +233,97 @@ TEST_PROCEDURE(Board_IsKingInCheck) {
   TEST_END
 }
 
+TEST_PROCEDURE(Board_Hash) {
+  TEST_START
+  const std::vector<std::tuple<std::string, std::string, bool>> cases = {
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+     "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 7 12",
+     true},
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+     "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR b KQkq - 0 1",
+     false},
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+     "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQk - 0 1",
+     false},
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+     "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq c6 0 1",
+     false},
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+     "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBKQBNR w KQkq - 0 1",
+     false}
+  };
+  for (const auto&[fen1, fen2, equal_hashes]: cases) {
+    Board b1(fen1);
+    Board b2(fen2);
+    VERIFY_EQUALS(b1.Hash() == b2.Hash(), equal_hashes) << "failed for fen1 \"" << fen1 << "\" and fen2 \"" << fen2 << "\"";
+  }
+
+  // Hash updated by mutators has to match the one calculated from FEN.
+  Board board("r3k2r/8/8/8/8/8/4P3/R3K2R w KQkq - 0 1");
+  board.SetFigure(4, 1, '\0');
+  board.SetFigure(4, 3, 'P');
+  board.SetEnPassantTargetSquare(Square("e3"));
+  board.UnsetCanCastle(Castling::Q);
+  board.UnsetCanCastle(Castling::Q);
+  board.ChangeSideToMove();
+  VERIFY_EQUALS(board.Hash(), Board("r3k2r/8/8/8/4P3/8/8/R3K2R b Kkq e3 0 1").Hash());
+  board.InvalidateEnPassantTargetSquare();
+  // Setting an invalid square only clears the current one.
+  board.SetEnPassantTargetSquare(Square("e3"));
+  board.SetEnPassantTargetSquare(Square());
+  board.SetFigure(0, 7, 'Q');
+  board.ChangeSideToMove();
+  VERIFY_EQUALS(board.Hash(), Board("Q3k2r/8/8/8/4P3/8/8/R3K2R w Kkq - 0 1").Hash());
+  TEST_END
+}
+
+TEST_PROCEDURE(Board_MakeMove_and_UnmakeMove) {
+  TEST_START
+  auto S = [](const std::string& square) -> size_t {
+    return SquareIndex(square[0] - 'a', square[1] - '1');
+  };
+  const std::vector<std::tuple<std::string, Move, std::string>> cases = {
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+     Move(S("e2"), S("e4"), Move::DOUBLE_PAWN_PUSH),
+     "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1"},
+    {"rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1",
+     Move(S("g8"), S("f6")),
+     "rnbqkb1r/pppppppp/5n2/8/4P3/8/PPPP1PPP/RNBQKBNR w KQkq - 1 2"},
+    {"r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 3 7",
+     Move(S("e1"), S("g1"), Move::KING_SIDE_CASTLING),
+     "r3k2r/8/8/8/8/8/8/R4RK1 b kq - 4 7"},
+    {"r3k2r/8/8/8/8/8/8/R3K2R b KQkq - 3 7",
+     Move(S("e8"), S("c8"), Move::QUEEN_SIDE_CASTLING),
+     "2kr3r/8/8/8/8/8/8/R3K2R w KQ - 4 8"},
+    {"r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 3 7",
+     Move(S("a1"), S("a8"), Move::CAPTURE),
+     "R3k2r/8/8/8/8/8/8/4K2R b Kk - 0 7"},
+    {"4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 9",
+     Move(S("e5"), S("d6"), Move::EN_PASSANT),
+     "4k3/8/3P4/8/8/8/8/4K3 b - - 0 9"},
+    {"4k3/8/8/8/3pP3/8/8/4K3 b - e3 0 9",
+     Move(S("d4"), S("e3"), Move::EN_PASSANT),
+     "4k3/8/8/8/8/4p3/8/4K3 w - - 0 10"},
+    {"1n2k3/P7/8/8/8/8/8/4K3 w - - 5 9",
+     Move::Promotion(S("a7"), S("b8"), KNIGHT, true),
+     "1N2k3/8/8/8/8/8/8/4K3 b - - 0 9"},
+    {"4k3/8/8/8/8/8/p7/4K3 b - - 5 9",
+     Move::Promotion(S("a2"), S("a1"), QUEEN, false),
+     "4k3/8/8/8/8/8/8/q3K3 w - - 0 10"}
+  };
+
+  for (const auto&[fen, move, expected_fen]: cases) {
+    Board board(fen);
+    const Board initial_board(fen);
+    const UndoInfo undo = board.MakeMove(move);
+    VERIFY_TRUE(board == Board(expected_fen)) << "failed for fen \"" << fen << "\" and move " << move;
+    VERIFY_TRUE(FiguresMatchBitboards(board)) << "failed for fen \"" << fen << "\" and move " << move;
+    VERIFY_TRUE(initial_board.BoardAfterMove(move) == board) << "failed for fen \"" << fen << "\" and move " << move;
+    board.UnmakeMove(move, undo);
+    VERIFY_TRUE(board == initial_board) << "failed for fen \"" << fen << "\" and move " << move;
+    VERIFY_TRUE(FiguresMatchBitboards(board)) << "failed for fen \"" << fen << "\" and move " << move;
+  }
+  TEST_END
+}
+
 } // unnamed namespace
@@ -4,93 +4,93 @@
 #include <cassert>
 #include <cstdlib>
 #include <ctime>
+#include <thread>
 
+#include "MovePicker.h"
+#include "Stopwatch.h"
 #include "utils/Timer.h"
 
 
 namespace {
 
-static double PawnValue = 1.0;
-static double KnightValue = 3.0;
-static double BishopValue = 3.0;
-static double RookValue = 5.0;
-static double QueenValue = 8.0;
-
-static int BorderValue =  1000;
-
 // Returns random value from range [0, max).
 size_t GetRandomNumber(size_t max) {
   return rand() % max;
 }
 
-double CalculateFiguresValue(const Board& board) {
-  double result = 0.0;
-  for (size_t x = 0; x < 8u; ++x) {
-    for (size_t y = 0; y < 8u; ++y) {
-      switch (board.at(x, y)) {
-        case 'Q':
-          result += QueenValue;
-          break;
-        case 'q':
-          result -= QueenValue;
-          break;
-        case 'R':
-          result += RookValue;
-          break;
-        case 'r':
-          result -= RookValue;
-          break;
-        case 'B':
-          result += BishopValue;
-          break;
-        case 'b':
-          result -= BishopValue;
-          break;
-        case 'N':
-          result += KnightValue;
-          break;
-        case 'n':
-          result -= KnightValue;
-          break;
-        case 'P':
-          result += PawnValue;
-          break;
-        case 'p':
-          result -= PawnValue;
-          break;
-        case 'K':
-        case 'k':
-          break;
-        default:
-          assert(board.at(x, y) == 0x0);
-          break;
-      }
+// Material in centipawns, positive when the side to move is ahead.
+int EvaluatePosition(const Board& board) {
+  int result = 0;
+  for (size_t type = PAWN; type < KING; ++type) {
+    for (const bool white: {true, false}) {
+      const FigureType figure = static_cast<FigureType>(type);
+      result += PieceValues[MakePiece(white, figure)] * static_cast<int>(PopCount(board.Figures(white, figure)));
     }
   }
-  return result;
+  result *= 100;
+  return board.WhiteToMove() ? result : -result;
 }
 
-double EvaluateMove(const Board& board) {
-  double result = CalculateFiguresValue(board);
-  return result;
+// Mate scores are stored relative to the node rather than the root, as the
+// same position may be reached at different plies.
+int ScoreToTable(int score, unsigned ply, int mate_bound) {
+  if (score >= mate_bound) {
+    return score + static_cast<int>(ply);
+  }
+  if (score <= -mate_bound) {
+    return score - static_cast<int>(ply);
+  }
+  return score;
 }
 
-bool IsMate(const Board& board) {
-  MoveCalculator calculator;
-  return calculator.CalculateAllMoves(board).empty() &&
-         board.IsKingInCheck(board.WhiteToMove());
-
+int ScoreFromTable(int score, unsigned ply, int mate_bound) {
+  if (score >= mate_bound) {
+    return score - static_cast<int>(ply);
+  }
+  if (score <= -mate_bound) {
+    return score + static_cast<int>(ply);
+  }
+  return score;
 }
 
 }  // unnamed namespace
 
 
-Engine::EngineMove::EngineMove(const Board& b) : board(std::move(b)) {}
+struct Engine::SplitPoint {
+  SplitPoint(const Board& b, MovePicker& pk, const SplitPoint* p, Worker& o,
+             unsigned d, unsigned pl, int a, int bt, Move m)
+    : board(b), picker(pk), parent(p), owner(o), depth(d), ply(pl), beta(bt), alpha(a), best_move(m) {}
 
-void Engine::EngineMove::Evaluate() {
-  eval = EvaluateMove(board);
-  mate_in = IsMate(board) ? (board.WhiteToMove() ? -1 : 1) : 0;
-}
+  // Tells whether given split point is this one or one of its parents.
+  bool IsBelow(const SplitPoint* split_point) const {
+    for (const SplitPoint* current = this; current; current = current->parent) {
+      if (current == split_point) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Position at the node; its owner doesn't touch it until the split is
+  // over, and every thread taking one of its moves makes its own copy.
+  const Board& board;
+  // Hands out the remaining moves of the node one at a time.
+  MovePicker& picker;
+  const SplitPoint* const parent;
+  Worker& owner;
+  const unsigned depth;
+  const unsigned ply;
+  const int beta;
+  // Guards picker and board (both cache data on the fly), alpha, best_move
+  // and owner's principal variation at ply.
+  std::mutex mutex;
+  int alpha;
+  Move best_move;
+  std::atomic<bool> cutoff{false};
+  // Threads searching one of its moves; the split point lives until it
+  // has no moves left to hand out and this drops to 0.
+  std::atomic<unsigned> searching{0u};
+};
 
 Engine::Engine(unsigned depth) : max_depth_(depth) {
   srand(static_cast<unsigned int>(clock()));
@@ -102,189 +102,314 @@ Engine::Engine(unsigned depth, unsigned time)
   srand(static_cast<unsigned int>(clock()));
 }
 
-Engine::EngineMoves Engine::GenerateEngineMovesForBoard(const Board& board) {
-  EngineMoves result;
-  MoveCalculator calculator;
-  auto moves = calculator.CalculateAllMoves(board);
-  for (const auto& move: moves) {
-    result.push_back(EngineMove(move.board));
+void Engine::Worker::UpdateKillers(Move move, unsigned ply) {
+  if (killers[ply][0] != move) {
+    killers[ply][1] = killers[ply][0];
+    killers[ply][0] = move;
   }
-  nodes_calculated_ += result.size();
-  return result;
 }
 
-Move Engine::FindMoveForBoard(const Board& initial_board, const Board& dest_board) const {
-  MoveCalculator calculator;
-  auto moves = calculator.CalculateAllMoves(initial_board);
-  auto iter = std::find_if(moves.begin(), moves.end(), [dest_board](const Move& move) {
-    return move.board == dest_board;
-  });
-  assert(iter != moves.end());
-  return *iter;
+void Engine::Worker::UpdatePrincipalVariation(Move move, unsigned ply) {
+  pv[ply][ply] = move;
+  for (unsigned i = ply + 1u; i < pv_length[ply + 1u]; ++i) {
+    pv[ply][i] = pv[ply + 1u][i];
+  }
+  pv_length[ply] = std::max(pv_length[ply + 1u], ply + 1u);
 }
 
-void Engine::GenerateNextDepth(EngineMoves& moves) {
+void Engine::Worker::UpdatePrincipalVariation(Move move, unsigned ply, const Worker& child) {
+  pv[ply][ply] = move;
+  for (unsigned i = ply + 1u; i < child.pv_length[ply + 1u]; ++i) {
+    pv[ply][i] = child.pv[ply + 1u][i];
+  }
+  pv_length[ply] = std::max(child.pv_length[ply + 1u], ply + 1u);
+}
+
+bool Engine::Stopped(const SplitPoint* split_point) const {
   if (!continue_calculations_) {
-    return;
+    return true;
   }
-  for (auto& move: moves) {
-    if (move.children.empty()) {
-      move.children = GenerateEngineMovesForBoard(move.board);
-    } else {
-      GenerateNextDepth(move.children);
+  for (; split_point; split_point = split_point->parent) {
+    if (split_point->cutoff) {
+      return true;
     }
   }
+  return false;
 }
 
-double Engine::FindBestEval(const EngineMoves& moves) const {
-  double result = playing_white_ ? -1000.0 : 1000.0;
-  for (const auto& move: moves) {
-    if ((playing_white_ && move.eval > result) ||
-        (!playing_white_ && move.eval < result)) {
-      result = move.eval;
+int Engine::Search(Worker& worker, Board& board, unsigned depth, int alpha, int beta,
+                   unsigned ply, bool follow_pv) {
+  ++worker.nodes;
+  worker.pv_length[ply] = ply;
+  const bool in_check = board.IsKingInCheck(board.WhiteToMove());
+  if (depth == 0u || ply == MAX_PLY - 1u) {
+    const MoveCalculator calculator;
+    if (in_check && !calculator.HasAnyLegalMove(board)) {
+      return -MATE_SCORE + static_cast<int>(ply);
+    }
+    return EvaluatePosition(board);
+  }
+  const int mate_bound = MATE_SCORE - static_cast<int>(MAX_PLY);
+  TranspositionTable::Data entry{Move(), 0, 0u, TranspositionTable::NONE};
+  if (table_.Probe(board.Hash(), entry) && entry.depth >= depth && !follow_pv) {
+    const int score = ScoreFromTable(entry.score, ply, mate_bound);
+    if (entry.bound == TranspositionTable::EXACT ||
+        (entry.bound == TranspositionTable::LOWER && score >= beta) ||
+        (entry.bound == TranspositionTable::UPPER && score <= alpha)) {
+      return std::min(std::max(score, alpha), beta);
+    }
+  }
+  const Move pv_move =
+    (follow_pv && ply < worker.previous_pv_length) ? worker.previous_pv[ply] : Move();
+  MovePicker picker(board, pv_move.IsNull() ? entry.move : pv_move,
+                    worker.killers[ply][0], worker.killers[ply][1]);
+  const int original_alpha = alpha;
+  Move best_move = Move();
+  bool any_move = false;
+  for (Move move = picker.NextMove(); !move.IsNull(); move = picker.NextMove()) {
+    any_move = true;
+    const UndoInfo undo = board.MakeMove(move);
+    const int score = -Search(worker, board, depth - 1u, -beta, -alpha, ply + 1u,
+                              follow_pv && move == pv_move);
+    board.UnmakeMove(move, undo);
+    if (Stopped(worker.split_point)) {
+      return 0;
+    }
+    if (score > alpha) {
+      alpha = score;
+      best_move = move;
+      worker.UpdatePrincipalVariation(move, ply);
+      if (alpha >= beta) {
+        if (!move.IsCapture() && !move.IsPromotion()) {
+          worker.UpdateKillers(move, ply);
+        }
+        break;
+      }
+    }
+    if (parallel_mode_ == ParallelMode::WORK_STEALING && depth >= MIN_SPLIT_DEPTH && idle_workers_ > 0u) {
+      alpha = Split(worker, board, picker, depth, alpha, beta, ply, best_move);
+      if (Stopped(worker.split_point)) {
+        return 0;
+      }
+      break;
     }
   }
-  return result;
+  if (!any_move) {
+    return in_check ? -MATE_SCORE + static_cast<int>(ply) : 0;
+  }
+  const TranspositionTable::Bound bound =
+    alpha >= beta ? TranspositionTable::LOWER :
+    alpha > original_alpha ? TranspositionTable::EXACT : TranspositionTable::UPPER;
+  table_.Store(board.Hash(), best_move, ScoreToTable(alpha, ply, mate_bound), depth, bound);
+  return alpha;
 }
 
-Engine::EngineMoves Engine::FindMovesWithEvalInRoot(double eval) const {
-  EngineMoves result;
-  for (const auto& move: root_) {
-    if (move.eval == eval) {
-      result.push_back(move);
+int Engine::Split(Worker& worker, const Board& board, MovePicker& picker, unsigned depth,
+                  int alpha, int beta, unsigned ply, Move& best_move) {
+  SplitPoint split_point(board, picker, worker.split_point, worker, depth, ply, alpha, beta, best_move);
+  {
+    std::lock_guard<std::mutex> lock(worker.split_points_mutex);
+    worker.split_points.push_back(&split_point);
+  }
+  Task task;
+  while (TakeMove(split_point, task)) {
+    RunTask(worker, task);
+  }
+  {
+    // No other thread can join the split point after this.
+    std::lock_guard<std::mutex> lock(worker.split_points_mutex);
+    auto& split_points = worker.split_points;
+    split_points.erase(std::remove(split_points.begin(), split_points.end(), &split_point),
+                       split_points.end());
+  }
+  // Threads still searching moves of the split point may split again below
+  // it; the owner helps them rather than just wait.
+  ++idle_workers_;
+  while (split_point.searching > 0u) {
+    if (StealTask(worker, &split_point, task)) {
+      --idle_workers_;
+      RunTask(worker, task);
+      ++idle_workers_;
+    } else {
+      std::this_thread::yield();
     }
   }
-  return result;
+  --idle_workers_;
+  best_move = split_point.best_move;
+  return split_point.alpha;
 }
 
-int Engine::CheckForMate(const EngineMoves& moves) const {
-  int result = playing_white_ ? 1000 : -1000;
-  bool mate_found = false;
-  for (const auto& move: moves) {
-    if (!move.mate_in) {
-      continue;
-    }
-    if ((playing_white_ && move.mate_in > 0 && move.mate_in < result) ||
-        (!playing_white_ && move.mate_in < 0 && move.mate_in > result)) {
-      result = move.mate_in;
-      mate_found = true;
-    }
+bool Engine::TakeMove(SplitPoint& split_point, Task& task) {
+  std::lock_guard<std::mutex> lock(split_point.mutex);
+  if (Stopped(&split_point)) {
+    return false;
   }
-  return mate_found ? result : 0;
+  const Move move = split_point.picker.NextMove();
+  if (move.IsNull()) {
+    return false;
+  }
+  ++split_point.searching;
+  task = {&split_point, move};
+  return true;
 }
 
-Engine::EngineMoves Engine::FindMovesWithMateInInRoot(int mate_in) const {
-  EngineMoves result;
-  for (const auto& move: root_) {
-    if (move.mate_in == mate_in) {
-      result.push_back(move);
+void Engine::RunTask(Worker& worker, const Task& task) {
+  SplitPoint& split_point = *task.split_point;
+  std::unique_lock<std::mutex> lock(split_point.mutex);
+  Board board = split_point.board;
+  const int alpha = split_point.alpha;
+  lock.unlock();
+  const SplitPoint* previous_split_point = worker.split_point;
+  worker.split_point = &split_point;
+  board.MakeMove(task.move);
+  const int score = -Search(worker, board, split_point.depth - 1u, -split_point.beta, -alpha,
+                            split_point.ply + 1u, false);
+  worker.split_point = previous_split_point;
+  if (!Stopped(&split_point)) {
+    lock.lock();
+    if (score > split_point.alpha) {
+      split_point.alpha = score;
+      split_point.best_move = task.move;
+      split_point.owner.UpdatePrincipalVariation(task.move, split_point.ply, worker);
+      if (score >= split_point.beta) {
+        split_point.cutoff = true;
+      }
     }
+    lock.unlock();
   }
-  return result;
+  --split_point.searching;
 }
 
-Engine::BorderValues Engine::GetBorderValuesForChildren(const EngineMove& parent) const {
-  int the_lowest_value = BorderValue;
-  int the_biggest_negative_value = -BorderValue;
-  int the_biggest_value = -BorderValue;
-  int the_lowest_positive_value = BorderValue;
-  BorderValues border_values;
-  for (const EngineMove& child: parent.children) {
-    if (child.mate_in == 0) {
-      border_values.is_zero = true;
-    } else if (child.mate_in < 0) {
-      if (child.mate_in < the_lowest_value) {
-        the_lowest_value = child.mate_in;
-      }
-      if (child.mate_in > the_biggest_negative_value) {
-        the_biggest_negative_value = child.mate_in;
-      }
-    } else if (child.mate_in > 0) {
-      if (child.mate_in > the_biggest_value) {
-        the_biggest_value = child.mate_in;
-      }
-      if (child.mate_in < the_lowest_positive_value) {
-        the_lowest_positive_value = child.mate_in;
+bool Engine::StealTask(const Worker& thief, const SplitPoint* below, Task& task) {
+  for (unsigned i = 1u; i < threads_; ++i) {
+    Worker& victim = workers_[(thief.id + i) % threads_];
+    std::lock_guard<std::mutex> lock(victim.split_points_mutex);
+    auto& split_points = victim.split_points;
+    // Outermost split points go first, as their moves have most work below.
+    for (auto it = split_points.begin(); it != split_points.end();) {
+      if (below && !(*it)->IsBelow(below)) {
+        ++it;
+      } else if (TakeMove(**it, task)) {
+        return true;
+      } else {
+        it = split_points.erase(it);
       }
     }
   }
-  if (the_lowest_value != BorderValue) {
-    border_values.the_lowest_value = the_lowest_value;
-  }
-  if (the_biggest_negative_value != -BorderValue) {
-    border_values.the_biggest_negative_value = the_biggest_negative_value;
-  }
-  if (the_biggest_value != -BorderValue) {
-    border_values.the_biggest_value = the_biggest_value;
-  }
-  if (the_lowest_positive_value != BorderValue) {
-    border_values.the_lowest_positive_value = the_lowest_positive_value;
-  }
-  return border_values;
+  return false;
 }
 
-bool Engine::UpdateMoveMovesToMateBasedOnChildren(EngineMove& move) const {
-  const bool is_my_move = playing_white_ == move.board.WhiteToMove();
-  BorderValues border_values = GetBorderValuesForChildren(move);
-  int result = 0;
-  if ((playing_white_ && is_my_move) ||
-      (!playing_white_ && !is_my_move)) {
-    if (border_values.the_lowest_positive_value != BorderValues::NOT_SET) {
-      result = border_values.the_lowest_positive_value;
-    } else if (border_values.is_zero) {
-      result = 0;
-    } else {
-      assert(border_values.the_lowest_value < 0);
-      result = border_values.the_lowest_value;
-    }
-  } else if ((!playing_white_ && is_my_move) ||
-             (playing_white_ && !is_my_move)) {
-    if (border_values.the_biggest_negative_value != BorderValues::NOT_SET) {
-      result = border_values.the_biggest_negative_value;
-    } else if (border_values.is_zero) {
-      result = 0;
+void Engine::HelpSearch(Worker& worker) {
+  Task task;
+  ++idle_workers_;
+  while (continue_calculations_) {
+    if (StealTask(worker, nullptr, task)) {
+      --idle_workers_;
+      RunTask(worker, task);
+      ++idle_workers_;
     } else {
-      assert(border_values.the_biggest_value > 0);
-      result = border_values.the_biggest_value;
+      std::this_thread::yield();
     }
   }
-  if (result > 0) {
-    move.mate_in = result + 1;
-  } else if (result < 0) {
-    move.mate_in = result - 1;
-  }
-  return result != 0;
+  --idle_workers_;
 }
 
-void Engine::UpdateMoveEvalBasedOnChildren(EngineMove& move) const {
+bool Engine::SearchRoot(Worker& worker, Board& board, unsigned depth,
+                        std::vector<RootMove>& root_moves, std::vector<Move>& best_moves) {
+  best_moves.clear();
+  worker.pv_length[0] = 0u;
+  int best_score = -INFINITE_SCORE;
+  for (auto& root_move: root_moves) {
+    const Move move = root_move.move;
+    const UndoInfo undo = board.MakeMove(move);
+    // Window starts just below the best score, so that moves as good as the
+    // best one get exact scores and one of them can be picked at random.
+    root_move.score = -Search(worker, board, depth - 1u, -INFINITE_SCORE, -(best_score - 1), 1u,
+                              worker.previous_pv_length > 0u && move == worker.previous_pv[0]);
+    board.UnmakeMove(move, undo);
+    if (Stopped(worker.split_point)) {
+      return false;
+    }
+    if (root_move.score > best_score) {
+      best_score = root_move.score;
+      best_moves.clear();
+      worker.UpdatePrincipalVariation(move, 0u);
+    }
+    if (root_move.score == best_score) {
+      best_moves.push_back(move);
+    }
+  }
+  std::copy(worker.pv[0].begin(), worker.pv[0].begin() + worker.pv_length[0],
+            worker.previous_pv.begin());
+  worker.previous_pv_length = worker.pv_length[0];
+  // Scores of moves worse than the best one are only upper bounds, but
+  // they're still good enough to order the next iteration.
+  std::stable_sort(root_moves.begin(), root_moves.end(),
+                   [](const RootMove& m1, const RootMove& m2) { return m1.score > m2.score; });
+  return true;
 }
 
-void Engine::EvaluateChildrenAndUpdateParent(EngineMoves& parent) const {
-  for (auto& move: parent) {
-    if (move.children.empty()) {
-      move.Evaluate();
-    } else {
-      EvaluateChildrenAndUpdateParent(move.children);
-      if (!UpdateMoveMovesToMateBasedOnChildren(move)) {
-        UpdateMoveEvalBasedOnChildren(move);
+std::vector<Move> Engine::IterativeDeepening(Worker& worker, const Board& board, const MoveList& moves) {
+  Stopwatch stopwatch;
+  Board position = board;
+  std::vector<RootMove> root_moves;
+  for (const auto& move: moves) {
+    root_moves.push_back({move, 0});
+  }
+  std::rotate(root_moves.begin(), root_moves.begin() + worker.id % root_moves.size(), root_moves.end());
+  std::vector<Move> best_moves;
+  std::vector<Move> iteration_best_moves;
+  double previous_iteration_time = 0.0;
+  // Average growth of iteration time from one depth to the next.
+  double branching_factor = MAX_BRANCHING_FACTOR;
+  for (unsigned depth = 1u + worker.id % 2u; depth <= max_depth_; ++depth) {
+    const double iteration_start = stopwatch.Milliseconds();
+    if (!SearchRoot(worker, position, depth, root_moves, iteration_best_moves)) {
+      // Root moves searched before time ran out still count: the first of
+      // them is the previous iteration's best one, so whatever they found
+      // is at least as good as the previous result.
+      if (!iteration_best_moves.empty()) {
+        best_moves.swap(iteration_best_moves);
+      }
+      break;
+    }
+    best_moves.swap(iteration_best_moves);
+    if (std::abs(root_moves.front().score) >= MATE_SCORE - static_cast<int>(MAX_PLY)) {
+      // Deeper iterations can't find a shorter mate.
+      break;
+    }
+    if (max_time_ && worker.id == 0u) {
+      const double now = stopwatch.Milliseconds();
+      const double iteration_time = now - iteration_start;
+      if (previous_iteration_time > 0.0) {
+        const double growth = std::min(iteration_time / previous_iteration_time, MAX_BRANCHING_FACTOR);
+        branching_factor = (branching_factor + growth) / 2.0;
+      }
+      previous_iteration_time = iteration_time;
+      // Next iteration doesn't have to finish to be of use, but its first
+      // move, which takes about half of it, should.
+      if (now + iteration_time * branching_factor / 2.0 > max_time_) {
+        break;
       }
     }
   }
+  return best_moves;
 }
 
 Move Engine::CalculateBestMove(const Board& board) {
-  assert(max_depth_ > 0u);
+  assert(max_depth_ > 0u && max_depth_ < MAX_PLY);
   continue_calculations_ = true;
   nodes_calculated_ = 0u;
+  table_.NewSearch();
   utils::Timer timer;
   if (max_time_) {
     timer.start(max_time_, [this]() {
       continue_calculations_ = false;
     });
   }
-  playing_white_ = board.WhiteToMove();
-  root_ = GenerateEngineMovesForBoard(board);
-  if (root_.empty()) {
+  const MoveCalculator calculator;
+  const MoveList moves = calculator.CalculateAllMoves(board);
+  if (moves.empty()) {
     GameResult result = GameResult::DRAW;
     const bool is_mate = board.IsKingInCheck(board.WhiteToMove());
     if (is_mate) {
@@ -292,22 +417,33 @@ Move Engine::CalculateBestMove(const Board& board) {
     }
     throw NoMovesException(result);
   }
-  for (size_t i = 0; i < max_depth_ - 1; ++i) {
-    GenerateNextDepth(root_);
+  workers_.reset(new Worker[threads_]());
+  idle_workers_ = 0u;
+  std::vector<std::thread> helpers;
+  for (unsigned i = 1u; i < threads_; ++i) {
+    workers_[i].id = i;
+    helpers.emplace_back([this, &board, &moves, i]() {
+      if (parallel_mode_ == ParallelMode::WORK_STEALING) {
+        HelpSearch(workers_[i]);
+      } else {
+        IterativeDeepening(workers_[i], board, moves);
+      }
+    });
   }
-  EvaluateChildrenAndUpdateParent(root_);
-  EngineMoves best_moves;
-  int mate_in = CheckForMate(root_);
-  if (mate_in) {
-    best_moves = FindMovesWithMateInInRoot(mate_in);
-  } else {
-    double best_eval = FindBestEval(root_);
-    best_moves = FindMovesWithEvalInRoot(best_eval);
+  const std::vector<Move> best_moves = IterativeDeepening(workers_[0], board, moves);
+  continue_calculations_ = false;
+  for (auto& helper: helpers) {
+    helper.join();
   }
-  assert(!best_moves.empty());
-  size_t index = GetRandomNumber(best_moves.size());
   if (max_time_) {
     timer.stop();
   }
-  return FindMoveForBoard(board, best_moves[index].board);
+  for (unsigned i = 0u; i < threads_; ++i) {
+    nodes_calculated_ += workers_[i].nodes;
+  }
+  if (best_moves.empty()) {
+    // Time ran out before the first root move was searched.
+    return moves[GetRandomNumber(moves.size())];
+  }
+  return best_moves[GetRandomNumber(best_moves.size())];
 }
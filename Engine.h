@@ -1,65 +1,147 @@
 #ifndef ENGINE_H
 #define ENGINE_H
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 #include "Board.h"
 #include "MoveCalculator.h"
+#include "TranspositionTable.h"
 #include "Types.h"
 
+class MovePicker;
 
 struct NoMovesException {
   NoMovesException(GameResult r) : result(r) {}
   const GameResult result;
 };
 
+// How threads share the work when more than one of them is searching.
+enum class ParallelMode {
+  // Every thread searches the whole tree; they only share the hash table.
+  SHARED_HASH,
+  // Young brothers wait: once the first move of a node has been searched,
+  // and some thread is idle, the node becomes a split point on its owner's
+  // deque, from which idle threads steal its remaining moves.
+  WORK_STEALING
+};
+
 class Engine {
  public:
   Engine(unsigned max_depth);
   Engine(unsigned max_depth, unsigned max_time_for_move);
   Move CalculateBestMove(const Board& board);
   unsigned NodesCalculated() const { return nodes_calculated_; }
+  // Clears the transposition table.
+  void SetHashSize(size_t size_in_mb) { table_.Resize(size_in_mb); }
+  // Read-only, for diagnostics: lets tests and tools inspect what the last
+  // search stored. The search itself never goes through it.
+  const TranspositionTable& HashTable() const { return table_; }
+  // Number of threads searching in parallel, sharing the transposition
+  // table; the result is always the one of the first of them.
+  void SetThreads(unsigned threads) { threads_ = std::max(threads, 1u); }
+  void SetParallelMode(ParallelMode mode) { parallel_mode_ = mode; }
 
  private:
-  struct EngineMove {
-    EngineMove(const Board& move);
-    void Evaluate();
+  static const unsigned MAX_PLY = 64u;
+  // Scores are in centipawns from the side to move's point of view. Mate
+  // in n plies is scored MATE_SCORE - n, so that shorter mates are preferred.
+  static const int MATE_SCORE = 100000;
+  static const int INFINITE_SCORE = MATE_SCORE + 1;
+  static const size_t DEFAULT_HASH_SIZE_IN_MB = 16u;
+  static constexpr double MAX_BRANCHING_FACTOR = 6.0;
+  // Smaller subtrees aren't worth handing over to another thread.
+  static const unsigned MIN_SPLIT_DEPTH = 3u;
 
-    Board board;
-    double eval{0};
-    int mate_in{0};
-    std::vector<EngineMove> children;
+  struct RootMove {
+    Move move;
+    int score;
   };
 
-  struct BorderValues {
-    static const int NOT_SET = 999;
-    bool is_zero{false};
-    int the_biggest_value{NOT_SET};
-    int the_lowest_value {NOT_SET};
-    int the_biggest_negative_value{NOT_SET};
-    int the_lowest_positive_value{NOT_SET};
+  // Node whose remaining moves are searched by several threads.
+  struct SplitPoint;
+
+  struct Task {
+    SplitPoint* split_point;
+    Move move;
   };
 
-  using EngineMoves = std::vector<EngineMove>;
+  // State of one search thread.
+  struct Worker {
+    void UpdateKillers(Move move, unsigned ply);
+    void UpdatePrincipalVariation(Move move, unsigned ply);
+    // Same, but the line below comes from the worker which searched the move.
+    void UpdatePrincipalVariation(Move move, unsigned ply, const Worker& child);
+
+    // Helpers (all but the first worker) vary their depths and root move
+    // order, so that they don't just repeat the first worker's search.
+    unsigned id{0u};
+    unsigned nodes{0u};
+    // Quiet moves which caused a cutoff at given ply, tried early by siblings.
+    std::array<std::array<Move, 2u>, MAX_PLY> killers{};
+    // Triangular table: line of best moves found below every ply of the
+    // current iteration.
+    std::array<std::array<Move, MAX_PLY>, MAX_PLY> pv;
+    std::array<unsigned, MAX_PLY> pv_length;
+    std::array<Move, MAX_PLY> previous_pv;
+    unsigned previous_pv_length{0u};
+    // Innermost split point the worker is searching below; a cutoff there
+    // or at any of its parents aborts the worker's search.
+    const SplitPoint* split_point{nullptr};
+    // Split points of this worker which may still have moves to hand out,
+    // innermost at the back.
+    std::deque<SplitPoint*> split_points;
+    std::mutex split_points_mutex;
+  };
 
-  EngineMoves GenerateEngineMovesForBoard(const Board& board);
-  Move FindMoveForBoard(const Board& initial_board, const Board& dest_board) const;
-  void GenerateNextDepth(EngineMoves& moves);
-  double FindBestEval(const EngineMoves& moves) const;
-  EngineMoves FindMovesWithEvalInRoot(double eval) const;
-  int CheckForMate(const EngineMoves& moves) const;
-  EngineMoves FindMovesWithMateInInRoot(int mate_in) const;
-  BorderValues GetBorderValuesForChildren(const EngineMove& parent) const;
-  void EvaluateChildrenAndUpdateParent(EngineMoves& parent) const;
-  bool UpdateMoveMovesToMateBasedOnChildren(EngineMove& move) const;
-  void UpdateMoveEvalBasedOnChildren(EngineMove& move) const;
+  // Deepens the search until max_depth_ is reached or time runs out.
+  // Returns the best moves of the deepest iteration which got through at
+  // least one root move.
+  std::vector<Move> IterativeDeepening(Worker& worker, const Board& board, const MoveList& moves);
+  // Searches all root moves to given depth, best ones from the previous
+  // iteration first. Returns false if time ran out before it was finished.
+  bool SearchRoot(Worker& worker, Board& board, unsigned depth,
+                  std::vector<RootMove>& root_moves, std::vector<Move>& best_moves);
+  // Depth-first negamax with alpha-beta pruning; plays moves on the given
+  // board in place and takes them back, so only one board is ever used.
+  // follow_pv tells that all moves leading here are on the previous
+  // iteration's principal variation, whose next move is then tried first.
+  int Search(Worker& worker, Board& board, unsigned depth, int alpha, int beta,
+             unsigned ply, bool follow_pv);
+  // Searches all moves left in the picker together with idle threads and
+  // returns alpha raised by them. Returns when all of them are done.
+  int Split(Worker& worker, const Board& board, MovePicker& picker, unsigned depth,
+            int alpha, int beta, unsigned ply, Move& best_move);
+  // Takes the next move of a split point unless it has none left or was
+  // cut off. The caller must make sure that the split point is alive.
+  bool TakeMove(SplitPoint& split_point, Task& task);
+  // Searches one move of a split point and merges its score.
+  void RunTask(Worker& worker, const Task& task);
+  // Takes a move of another worker's split point; only of ones at or below
+  // given split point, unless it's null.
+  bool StealTask(const Worker& thief, const SplitPoint* below, Task& task);
+  // Keeps an idle thread stealing tasks until the search is over.
+  void HelpSearch(Worker& worker);
+  // Tells whether time ran out or the search below split_point was cut off.
+  bool Stopped(const SplitPoint* split_point) const;
 
   unsigned max_depth_{0u};
   unsigned max_time_{0u};
-  EngineMoves root_;
-  bool playing_white_;
-  bool continue_calculations_;
-  unsigned nodes_calculated_;
+  unsigned threads_{1u};
+  ParallelMode parallel_mode_{ParallelMode::SHARED_HASH};
+  std::unique_ptr<Worker[]> workers_;
+  // Threads looking for a split point to help with.
+  std::atomic<unsigned> idle_workers_{0u};
+  // Cleared by the timer, or by the first worker once it's done.
+  std::atomic<bool> continue_calculations_{true};
+  unsigned nodes_calculated_{0u};
+  // Kept between moves of a game.
+  TranspositionTable table_{DEFAULT_HASH_SIZE_IN_MB};
 };
 
 #endif  // ENGINE_H
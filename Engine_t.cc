@@ -1,5 +1,6 @@
 /* Component tests for class Engine */
 
+#include <cctype>
 #include <string>
 #include <tuple>
 #include <vector>
@@ -7,6 +8,8 @@
 #include "Board.h"
 #include "Engine.h"
 #include "MoveCalculator.h"
+#include "Stopwatch.h"
+#include "TranspositionTable.h"
 #include "Types.h"
 #include "utils/Test.h"
 
@@ -23,11 +26,35 @@ bool MovesAreEqual(const Move& move, const std::string& expected_move) {
   COORDINATES_FROM_STRING(expected_move);
   char promotion_to = 0x0;
   if (expected_move.size() == 5u) {
-    promotion_to = expected_move[4u];
+    promotion_to = toupper(expected_move[4u]);
+  }
+  return move.OldX() == old_x && move.OldY() == old_y &&
+         move.NewX() == new_x && move.NewY() == new_y &&
+         move.PromotionTo() == promotion_to;
+}
+
+using BestMoveCases = std::vector<std::tuple<std::string, std::string>>;
+
+const BestMoveCases WinningMaterialCases = {
+  {"4k3/8/8/3q4/8/8/3R4/4K3 w - - 0 1", "d2d5"},
+  {"4k3/8/8/5N2/2q5/8/8/4K3 w - - 0 1", "f5d6"},
+  // Full board, so that a parallel search has work to share.
+  {"rnb1kbnr/pppp1ppp/8/4p3/4P2q/5N2/PPPP1PPP/RNBQKB1R w KQkq - 0 1", "f3h4"}
+};
+
+void VerifyBestMoves(const BestMoveCases& cases,
+                     unsigned depth,
+                     unsigned threads = 1u,
+                     ParallelMode mode = ParallelMode::SHARED_HASH,
+                     unsigned max_time_for_move = 0u) {
+  Engine engine(depth, max_time_for_move);
+  engine.SetThreads(threads);
+  engine.SetParallelMode(mode);
+  for (const auto&[fen, expected_move]: cases) {
+    Board board(fen);
+    auto move = engine.CalculateBestMove(board);
+    VERIFY_TRUE(MovesAreEqual(move, expected_move)) << "failed for fen \"" << fen << "\"; move: " << move;
   }
-  return move.old_x == old_x && move.old_y == old_y &&
-         move.new_x == new_x && move.new_y == new_y &&
-         move.promotion_to == promotion_to;
 }
 
 // ===============================================================
@@ -113,4 +140,88 @@ TEST_PROCEDURE(Engine_finds_mate_in_one) {
   TEST_END
 }
 
+TEST_PROCEDURE(Engine_wins_material) {
+  TEST_START
+  VerifyBestMoves(WinningMaterialCases, 6u);
+  TEST_END
+}
+
+TEST_PROCEDURE(Engine_returns_within_time_budget) {
+  TEST_START
+  // Maximal depth is far out of reach, so only time stops the search.
+  const Board board("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+  Engine engine(40u, 100u);
+  const MoveCalculator calculator;
+  Stopwatch stopwatch;
+  const Move move = engine.CalculateBestMove(board);
+  const double milliseconds = stopwatch.Milliseconds();
+  VERIFY_TRUE(milliseconds < 150.0) << "search took " << milliseconds << "ms";
+  VERIFY_TRUE(calculator.IsLegal(board, move)) << "move: " << move;
+  TEST_END
+}
+
+TEST_PROCEDURE(Engine_returns_searched_move_when_time_runs_out) {
+  TEST_START
+  // Only one move wins the queen, and every iteration finds it; a move
+  // picked without any root move searched would hardly ever be this one.
+  const Board board("rnb1kbnr/pppp1ppp/8/4p3/4P2q/5N2/PPPP1PPP/RNBQKB1R w KQkq - 0 1");
+  const MoveCalculator calculator;
+  for (const unsigned budget: {1u, 10u, 50u}) {
+    Engine engine(40u, budget);
+    const Move move = engine.CalculateBestMove(board);
+    VERIFY_TRUE(calculator.IsLegal(board, move)) << "failed for budget " << budget << "ms; move: " << move;
+    VERIFY_TRUE(MovesAreEqual(move, "f3h4")) << "failed for budget " << budget << "ms; move: " << move;
+  }
+  TEST_END
+}
+
+TEST_PROCEDURE(Engine_finds_mate_within_time_budget) {
+  TEST_START
+  // Budget is big enough for the full depth.
+  VerifyBestMoves({{"7k/4Q3/8/8/8/8/7B/6K1 w - - 0 1", "h2e5"},
+                   {"1r5k/6pp/7N/3Q4/8/8/6K1/8 w - - 0 1", "d5g8"}}, 3u, 1u,
+                  ParallelMode::SHARED_HASH, 5000u);
+  TEST_END
+}
+
+TEST_PROCEDURE(Engine_stores_no_move_for_failed_low_nodes) {
+  TEST_START
+  // Two plies from the root every position is reached by one line only,
+  // and in the last iteration of a depth 3 search it's first searched, to
+  // depth 1. Entries which failed low there have no better move to keep.
+  const Board board("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+  Engine engine(3u);
+  engine.CalculateBestMove(board);
+  const MoveCalculator calculator;
+  unsigned failed_low = 0u;
+  for (const auto& move: calculator.CalculateAllMoves(board)) {
+    Board child = board;
+    child.MakeMove(move);
+    for (const auto& reply: calculator.CalculateAllMoves(child)) {
+      Board grandchild = child;
+      grandchild.MakeMove(reply);
+      TranspositionTable::Data data;
+      if (engine.HashTable().Probe(grandchild.Hash(), data) &&
+          data.bound == TranspositionTable::UPPER && data.depth == 1u) {
+        ++failed_low;
+        VERIFY_TRUE(data.move.IsNull()) << "failed after " << move << " " << reply << "; move: " << data.move;
+      }
+    }
+  }
+  VERIFY_TRUE(failed_low > 0u);
+  TEST_END
+}
+
+TEST_PROCEDURE(Engine_wins_material_with_shared_hash_threads) {
+  TEST_START
+  VerifyBestMoves(WinningMaterialCases, 6u, 4u, ParallelMode::SHARED_HASH);
+  TEST_END
+}
+
+TEST_PROCEDURE(Engine_wins_material_with_work_stealing_threads) {
+  TEST_START
+  VerifyBestMoves(WinningMaterialCases, 6u, 4u, ParallelMode::WORK_STEALING);
+  TEST_END
+}
+
 }  // unnamed namespace
@@ -15,7 +15,7 @@ int main() {
       Move move = engine.CalculateBestMove(board);
       pgn_creator.AddMove(board, move);
       std::cout << move << std::endl;
-      board = move.board;
+      board.MakeMove(move);
     }
     pgn_creator.GameFinished(GameResult::DRAW);
   } catch (NoMovesException& e) {
@@ -0,0 +1,31 @@
+#ifndef HASH_ENTRY_H_
+#define HASH_ENTRY_H_
+
+#include <atomic>
+#include <cstdint>
+
+// Entry of a hash table shared by many threads without locking. It keeps
+// the position hash xored with its data, so an entry torn by concurrent
+// writes fails verification and reads as a miss.
+class HashEntry {
+ public:
+  // Returns the entry's data; it belongs to the given hash only if true
+  // is returned.
+  bool Load(uint64_t hash, uint64_t& data) const {
+    data = data_.load(std::memory_order_relaxed);
+    return (key_.load(std::memory_order_relaxed) ^ data) == hash;
+  }
+
+  void Store(uint64_t hash, uint64_t data) {
+    key_.store(hash ^ data, std::memory_order_relaxed);
+    data_.store(data, std::memory_order_relaxed);
+  }
+
+  void Clear() { Store(0u, 0u); }
+
+ private:
+  std::atomic<uint64_t> key_{0u};
+  std::atomic<uint64_t> data_{0u};
+};
+
+#endif  // HASH_ENTRY_H_
@@ -0,0 +1,102 @@
+#ifndef MOVE_H
+#define MOVE_H
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+
+#include "Bitboard.h"
+
+// Move packed into 16 bits: origin square in bits 0-5, destination square
+// in bits 6-11 and flags in bits 12-15. Squares are indexed as in Bitboard.h.
+// The color of the moving side (and thus of a promoted figure) is not stored;
+// it's implied by the board the move is played on.
+class Move {
+ public:
+  enum Flags : uint16_t {
+    QUIET = 0x0,
+    DOUBLE_PAWN_PUSH = 0x1,
+    KING_SIDE_CASTLING = 0x2,
+    QUEEN_SIDE_CASTLING = 0x3,
+    CAPTURE = 0x4,
+    EN_PASSANT = 0x5,
+    // Two lowest bits hold promoted figure (knight, bishop, rook, queen).
+    PROMOTION = 0x8
+  };
+
+  // Default constructed move is left uninitialized, so that MoveList
+  // doesn't have to fill its buffer; Move() is the null move.
+  Move() = default;
+  Move(size_t from, size_t to, uint16_t flags = QUIET)
+    : data_(static_cast<uint16_t>(from | (to << 6) | (flags << 12))) {}
+
+  static Move Promotion(size_t from, size_t to, FigureType figure, bool capture) {
+    return Move(from, to, PROMOTION | (capture ? CAPTURE : QUIET) | (figure - KNIGHT));
+  }
+
+  size_t From() const { return data_ & 0x3f; }
+  size_t To() const { return (data_ >> 6) & 0x3f; }
+  uint16_t GetFlags() const { return data_ >> 12; }
+  size_t OldX() const { return From() % 8u; }
+  size_t OldY() const { return From() / 8u; }
+  size_t NewX() const { return To() % 8u; }
+  size_t NewY() const { return To() / 8u; }
+
+  bool IsNull() const { return data_ == 0u; }
+  bool IsCapture() const { return GetFlags() & CAPTURE; }
+  bool IsEnPassant() const { return GetFlags() == EN_PASSANT; }
+  bool IsDoublePawnPush() const { return GetFlags() == DOUBLE_PAWN_PUSH; }
+  bool IsCastling() const {
+    return GetFlags() == KING_SIDE_CASTLING || GetFlags() == QUEEN_SIDE_CASTLING;
+  }
+  bool IsPromotion() const { return GetFlags() & PROMOTION; }
+  FigureType PromotionFigure() const {
+    return static_cast<FigureType>(KNIGHT + (GetFlags() & 0x3));
+  }
+  // Returns 'N', 'B', 'R' or 'Q' for promotions and '\0' otherwise.
+  char PromotionTo() const {
+    return IsPromotion() ? "NBRQ"[GetFlags() & 0x3] : '\0';
+  }
+
+  bool operator==(const Move& other) const { return data_ == other.data_; }
+  bool operator!=(const Move& other) const { return data_ != other.data_; }
+
+ private:
+  uint16_t data_;
+};
+
+static_assert(sizeof(Move) == 2u, "Move is expected to fit in 16 bits");
+
+// List of moves with fixed capacity, enough for any legal chess position.
+// It never allocates, so it's meant to be kept on the stack.
+class MoveList {
+ public:
+  static const size_t CAPACITY = 256u;
+
+  void push_back(Move move) {
+    assert(size_ < CAPACITY);
+    moves_[size_++] = move;
+  }
+  void clear() { size_ = 0u; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0u; }
+  Move& operator[](size_t index) { return moves_[index]; }
+  const Move& operator[](size_t index) const { return moves_[index]; }
+  Move* begin() { return moves_.data(); }
+  Move* end() { return moves_.data() + size_; }
+  const Move* begin() const { return moves_.data(); }
+  const Move* end() const { return moves_.data() + size_; }
+
+ private:
+  std::array<Move, CAPACITY> moves_;
+  size_t size_{0u};
+};
+
+inline std::ostream& operator<<(std::ostream& os, const Move& move) {
+  os << static_cast<char>(move.OldX() + 'a') << static_cast<char>(move.OldY() + '1') << "-";
+  os << static_cast<char>(move.NewX() + 'a') << static_cast<char>(move.NewY() + '1');
+  return os;
+}
+
+#endif  // MOVE_H
@@ -1,333 +1,423 @@
 #include "MoveCalculator.h"
 
 #include <cassert>
-#include <cctype>
 
 
-std::ostream& operator<<(std::ostream& os, const Move& move) {
-  os << static_cast<char>(move.old_x + 'a') << static_cast<char>(move.old_y + '1') << "-";
-  os << static_cast<char>(move.new_x + 'a') << static_cast<char>(move.new_y + '1');
-  return os;
+namespace {
+
+enum class GenerationMode {
+  ALL,
+  CAPTURES,
+  QUIETS
+};
+
+// State of a single generation call, so that MoveCalculator itself doesn't
+// have any. Specialized for the side to move.
+template <bool White>
+class MoveGenerator {
+ public:
+  // Moves are only counted if given list is null.
+  MoveGenerator(const Board& board, GenerationMode mode, MoveList* moves);
+
+  void GenerateAll();
+  // Stops after the first figure which has a legal move.
+  bool GenerateAny();
+  // Generates moves of the figure standing on given square only.
+  void GenerateForSquare(size_t square);
+  size_t Count() const { return count_; }
+
+ private:
+  bool GeneratesCaptures() const { return mode_ != GenerationMode::QUIETS; }
+  bool GeneratesQuiets() const { return mode_ != GenerationMode::CAPTURES; }
+  void HandleFigureMoves(size_t square, FigureType type);
+  void HandlePawnMoves(size_t square);
+  void HandleKnightMoves(size_t square);
+  void HandleBishopMoves(size_t square);
+  void HandleRookMoves(size_t square);
+  void HandleQueenMoves(size_t square);
+  void HandleKingMoves(size_t square);
+  void HandleCastlings(size_t square);
+  // Indexed by FigureType.
+  static constexpr void (MoveGenerator::*FigureHandlers[FIGURE_TYPES])(size_t) = {
+    &MoveGenerator::HandlePawnMoves,
+    &MoveGenerator::HandleKnightMoves,
+    &MoveGenerator::HandleBishopMoves,
+    &MoveGenerator::HandleRookMoves,
+    &MoveGenerator::HandleQueenMoves,
+    &MoveGenerator::HandleKingMoves
+  };
+  template <bool KingSide> bool CanCastle() const;
+  // Squares the current generation mode allows moving to.
+  Bitboard ModeTargets() const;
+  void AddMovesToSquares(size_t from, Bitboard squares);
+  void AddPromotions(size_t from, size_t to, bool capture);
+  void AddMove(Move move);
+  void CalculateChecksAndPins();
+  // Squares a non-king figure standing on given square may move to
+  // without leaving own king in check.
+  Bitboard LegalTargets(size_t square) const;
+  bool IsEnPassantLegal(size_t from, size_t to) const;
+
+  const Board& board_;
+  const GenerationMode mode_;
+  MoveList* const moves_;
+  size_t count_{0u};
+  size_t king_square_{0u};
+  Bitboard checkers_{0u};
+  // Squares which block or capture the checking figure; all squares when
+  // not in check, none in double check.
+  Bitboard check_mask_{0u};
+  Bitboard pinned_{0u};
+};
+
+template <bool White>
+MoveGenerator<White>::MoveGenerator(const Board& board, GenerationMode mode, MoveList* moves)
+  : board_(board), mode_(mode), moves_(moves) {
+  CalculateChecksAndPins();
 }
 
-std::vector<Move> MoveCalculator::CalculateAllMoves(const std::string& fen) {
-  Board board(fen);
-  return CalculateAllMoves(board);
+template <bool White>
+void MoveGenerator<White>::GenerateAll() {
+  for (size_t type = 0; type < FIGURE_TYPES; ++type) {
+    if (PopCount(checkers_) > 1u && type != KING) {
+      continue;
+    }
+    Bitboard figures = board_.Figures(White, static_cast<FigureType>(type));
+    while (figures) {
+      HandleFigureMoves(PopLowestSquare(figures), static_cast<FigureType>(type));
+    }
+  }
 }
 
-std::vector<Move> MoveCalculator::CalculateAllMoves(const Board& board) {
-  board_ = &board;
-  moves_.clear();
-  const bool white_to_move = board.WhiteToMove();
-  for (size_t x = 0; x < 8; ++x) {
-    for (size_t y = 0; y < 8; ++y) {
-      const char c = board.at(x, y);
-      if (!c || !!isupper(c) != white_to_move) {
-        continue;
-      }
-      switch (c) {
-        case 'P':
-        case 'p':
-          HandlePawnMoves(x, y);
-          break;
-        case 'B':
-        case 'b':
-          HandleBishopMoves(x, y);
-          break;
-        case 'N':
-        case 'n':
-          HandleKnightMoves(x, y);
-          break;
-        case 'R':
-        case 'r':
-          HandleRookMoves(x, y);
-          break;
-        case 'Q':
-        case 'q':
-          HandleQueenMoves(x, y);
-          break;
-        case 'K':
-        case 'k':
-          HandleKingMoves(x, y);
-          break;
-        default:
-          assert(!"Unexpeted char");
-          break;
+template <bool White>
+bool MoveGenerator<White>::GenerateAny() {
+  // King goes first: it's the only figure which can move in double check
+  // and it rarely has no move at all otherwise.
+  const FigureType types[] = {KING, PAWN, KNIGHT, BISHOP, ROOK, QUEEN};
+  for (const FigureType type: types) {
+    if (PopCount(checkers_) > 1u && type != KING) {
+      break;
+    }
+    Bitboard figures = board_.Figures(White, type);
+    while (figures) {
+      HandleFigureMoves(PopLowestSquare(figures), type);
+      if (count_ > 0u) {
+        return true;
       }
     }
   }
-  return moves_;
+  return false;
 }
 
-void MoveCalculator::CheckNewSquareAndMaybeAddMove(size_t old_x, size_t old_y, int new_x, int new_y) {
-  if (new_x >= 0 && new_x <= 7 && new_y >= 0 && new_y <= 7) {
-    MaybeAddMove(old_x, old_y, new_x, new_y);
+template <bool White>
+void MoveGenerator<White>::GenerateForSquare(size_t square) {
+  const Piece piece = board_.PieceAt(square);
+  assert(piece != NO_PIECE && IsWhite(piece) == White);
+  if (PopCount(checkers_) > 1u && TypeOf(piece) != KING) {
+    return;
   }
+  HandleFigureMoves(square, TypeOf(piece));
 }
 
-void MoveCalculator::UpdateCastlings(Board& copy, char figure, size_t old_x, size_t old_y) const {
-  if (figure == 'K') {
-    copy.UnsetCanCastle(Castling::K);
-    copy.UnsetCanCastle(Castling::Q);
-  } else if (figure == 'k') {
-    copy.UnsetCanCastle(Castling::k);
-    copy.UnsetCanCastle(Castling::q);
-  } else if (figure == 'R') {
-    if (old_x == 0u && old_y == 0u) {
-      copy.UnsetCanCastle(Castling::Q);
-    } else if (old_x == 7u && old_y == 0u) {
-      copy.UnsetCanCastle(Castling::K);
-    }
-  } else if (figure == 'r') {
-    if (old_x == 0u && old_y == 7u) {
-      copy.UnsetCanCastle(Castling::q);
-    } else if (old_x == 7u && old_y == 7u) {
-      copy.UnsetCanCastle(Castling::k);
-    }
-  }
+template <bool White>
+void MoveGenerator<White>::HandleFigureMoves(size_t square, FigureType type) {
+  assert(type < FIGURE_TYPES);
+  (this->*FigureHandlers[type])(square);
 }
 
-void MoveCalculator::UpdateEnPassantTargetSquare(Board& copy, char figure, size_t old_x, size_t old_y, size_t new_y) const {
-  if (figure == 'P' && old_y == 1u && new_y == 3u) {
-    copy.SetEnPassantTargetSquare(Square(old_x, 2u));
-  } else if (figure == 'p' && old_y == 6u && new_y == 4u) {
-    copy.SetEnPassantTargetSquare(Square(old_x, 5u));
+template <bool White>
+void MoveGenerator<White>::CalculateChecksAndPins() {
+  const CheckInfo& info = board_.GetCheckInfo();
+  king_square_ = info.king_square;
+  checkers_ = info.checkers;
+  pinned_ = info.pinned;
+  if (checkers_ == 0u) {
+    check_mask_ = ~Bitboard(0u);
+  } else if (PopCount(checkers_) == 1u) {
+    // Check by a slider can also be blocked.
+    const size_t checker = LowestSquare(checkers_);
+    check_mask_ = checkers_;
+    if (PieceIsSlider[board_.PieceAt(checker)]) {
+      check_mask_ |= SquaresBetween(king_square_, checker);
+    }
   } else {
-    copy.InvalidateEnPassantTargetSquare();
+    check_mask_ = 0u;
   }
 }
 
-void MoveCalculator::MaybeAddMove(size_t old_x, size_t old_y, size_t new_x, size_t new_y, bool promotion) {
-  char captured_figure = board_->at(new_x, new_y);
-  if (captured_figure && !!isupper(captured_figure) == board_->WhiteToMove()) {
-    return;
-  }
-  const char figure = board_->at(old_x, old_y);
-  const bool white_to_move = board_->WhiteToMove();
-  const Square en_passant_target_square = board_->EnPassantTargetSquare();
-  const bool en_passant_capture =
-      en_passant_target_square.x == new_x &&
-      en_passant_target_square.y == new_y &&
-      figure == (white_to_move ? 'P' : 'p');
-  Board copy = *board_;
-  assert(figure);
-  assert(captured_figure != 'K' && captured_figure != 'k');
-  copy.at(old_x, old_y) = '\0';
-  copy.at(new_x, new_y) = figure;
-  if (en_passant_capture) {
-    captured_figure = white_to_move ? 'p' : 'P';
-    const size_t captured_pawn_y = white_to_move ? 4u : 3u;
-    copy.at(en_passant_target_square.x, captured_pawn_y) = 0x0;
+template <bool White>
+Bitboard MoveGenerator<White>::LegalTargets(size_t square) const {
+  if (pinned_ & SquareBit(square)) {
+    return check_mask_ & LineThrough(king_square_, square);
   }
-  if (figure == 'K') {
-    copy.SetKingPosition(true, new_x, new_y);
-  } else if (figure == 'k') {
-    copy.SetKingPosition(false, new_x, new_y);
-  }
-  if (copy.IsKingInCheck(white_to_move)) {
+  return check_mask_;
+}
+
+template <bool White>
+bool MoveGenerator<White>::IsEnPassantLegal(size_t from, size_t to) const {
+  // Captured pawn stands next to the capturing one, so the position has to be
+  // checked as a whole: both pawns may be leaving the same rank at once.
+  const size_t captured = SquareIndex(to % 8u, from / 8u);
+  const Bitboard occupancy =
+    (board_.Occupancy() ^ SquareBit(from) ^ SquareBit(captured)) | SquareBit(to);
+  const Bitboard attackers =
+    board_.AttackersTo<!White>(king_square_, occupancy) & ~SquareBit(captured);
+  return attackers == 0u;
+}
+
+template <bool White>
+Bitboard MoveGenerator<White>::ModeTargets() const {
+  const Bitboard opponent = board_.Occupancy(!White);
+  const Bitboard empty = ~board_.Occupancy();
+  return (GeneratesCaptures() ? opponent : 0u) | (GeneratesQuiets() ? empty : 0u);
+}
+
+template <bool White>
+void MoveGenerator<White>::AddMovesToSquares(size_t from, Bitboard squares) {
+  const Bitboard opponent = board_.Occupancy(!White);
+  squares &= ModeTargets() & LegalTargets(from);
+  if (!moves_) {
+    count_ += PopCount(squares);
     return;
   }
-  copy.ChangeSideToMove();
-  if (!white_to_move) {
-    copy.IncrementFullMoveNumber();
-  }
-  if (captured_figure || figure == 'P' || figure == 'p') {
-    copy.ResetHalfMoveClock();
-  } else {
-    copy.IncrementHalfMoveClock();
-  }
-  UpdateCastlings(copy, figure, old_x, old_y);
-  UpdateEnPassantTargetSquare(copy, figure, old_x, old_y, new_y);
-  if (promotion) {
-    auto AddPromotionMove = [this, &copy, old_x, old_y, new_x, new_y, captured_figure](char promoted_to) {
-      copy.at(new_x, new_y) = promoted_to;
-      moves_.push_back({copy, old_x, old_y, new_x, new_y, promoted_to, !!captured_figure});
-    };
-    AddPromotionMove(white_to_move ? 'Q' : 'q');
-    AddPromotionMove(white_to_move ? 'R' : 'r');
-    AddPromotionMove(white_to_move ? 'N' : 'n');
-    AddPromotionMove(white_to_move ? 'B' : 'b');
-  } else {
-    moves_.push_back({std::move(copy), old_x, old_y, new_x, new_y, 0x0, !!captured_figure});
+  while (squares) {
+    const size_t to = PopLowestSquare(squares);
+    AddMove(Move(from, to, (opponent & SquareBit(to)) ? Move::CAPTURE : Move::QUIET));
   }
 }
 
-void MoveCalculator::HandleMovesHelper(size_t x, size_t y, int x_offset, int y_offset) {
-  int new_x = x;
-  int new_y = y;
-  while (1) {
-    new_x += x_offset;
-    new_y += y_offset;
-    if (new_x < 0 || new_x > 7 || new_y < 0 || new_y > 7) {
-      break;
-    }
-    MaybeAddMove(x, y, new_x, new_y);
-    if (board_->at(new_x, new_y)) {
-      break;
-    }
+template <bool White>
+void MoveGenerator<White>::AddPromotions(size_t from, size_t to, bool capture) {
+  AddMove(Move::Promotion(from, to, QUEEN, capture));
+  AddMove(Move::Promotion(from, to, ROOK, capture));
+  AddMove(Move::Promotion(from, to, KNIGHT, capture));
+  AddMove(Move::Promotion(from, to, BISHOP, capture));
+}
+
+template <bool White>
+void MoveGenerator<White>::AddMove(Move move) {
+  if (moves_) {
+    moves_->push_back(move);
+  } else {
+    ++count_;
   }
 }
 
-void MoveCalculator::HandlePawnMoves(size_t x, size_t y) {
+template <bool White>
+void MoveGenerator<White>::HandlePawnMoves(size_t square) {
+  constexpr size_t starting_rank = White ? 1u : 6u;
+  constexpr size_t promotion_rank = White ? 6u : 1u;
+  constexpr int offset = White ? 8 : -8;
+  const size_t y = square / 8u;
   assert(y != 0u && y != 7u);
-  const bool white_move = board_->WhiteToMove();
-  const size_t starting_rank = white_move ? 1u : 6u;
-  const bool promotion = white_move ? (y == 6u) : (y == 1u);
-  const int offset = white_move ? 1 : -1;
-  if (!board_->at(x, y + offset)) {
-    MaybeAddMove(x, y, x, y + offset, promotion);
-    if (y == starting_rank && !board_->at(x, y + 2 * offset)) {
-      MaybeAddMove(x, y, x, y + 2 * offset);
+  const bool promotion = (y == promotion_rank);
+  const Bitboard occupancy = board_.Occupancy();
+  const Bitboard targets = LegalTargets(square);
+  const size_t push_square = square + offset;
+  if (!(occupancy & SquareBit(push_square))) {
+    if (targets & SquareBit(push_square)) {
+      if (promotion) {
+        if (GeneratesCaptures()) {
+          AddPromotions(square, push_square, false);
+        }
+      } else if (GeneratesQuiets()) {
+        AddMove(Move(square, push_square));
+      }
     }
+    const size_t double_push_square = push_square + offset;
+    if (GeneratesQuiets() && y == starting_rank &&
+        !(occupancy & SquareBit(double_push_square)) &&
+        (targets & SquareBit(double_push_square))) {
+      AddMove(Move(square, double_push_square, Move::DOUBLE_PAWN_PUSH));
+    }
+  }
+  if (!GeneratesCaptures()) {
+    return;
   }
-  auto HandlePawnCaptureAtSquare = [this, x, y, promotion](size_t new_x, size_t new_y) {
-    bool is_en_passant_square = board_->EnPassantTargetSquare().x == new_x &&
-                                board_->EnPassantTargetSquare().y == new_y;
-    if (board_->at(new_x, new_y) || is_en_passant_square) {
-      MaybeAddMove(x, y, new_x, new_y, promotion);
+  Bitboard captures = PawnAttacks<White>(square);
+  const Square en_passant_square = board_.EnPassantTargetSquare();
+  if (!en_passant_square.IsInvalid() &&
+      (captures & SquareBit(en_passant_square.x, en_passant_square.y))) {
+    const size_t to = SquareIndex(en_passant_square.x, en_passant_square.y);
+    if (IsEnPassantLegal(square, to)) {
+      AddMove(Move(square, to, Move::EN_PASSANT));
     }
-  };
-  if (x < 7u) {
-    HandlePawnCaptureAtSquare(x + 1u, y + offset);
   }
-  if (x > 0u) {
-    HandlePawnCaptureAtSquare(x - 1u, y + offset);
+  captures &= board_.Occupancy(!White) & targets;
+  while (captures) {
+    const size_t to = PopLowestSquare(captures);
+    if (promotion) {
+      AddPromotions(square, to, true);
+    } else {
+      AddMove(Move(square, to, Move::CAPTURE));
+    }
   }
 }
 
-void MoveCalculator::HandleKnightMoves(size_t x, size_t y) {
-  CheckNewSquareAndMaybeAddMove(x, y, x + 2, y + 1);
-  CheckNewSquareAndMaybeAddMove(x, y, x + 2, y - 1);
-  CheckNewSquareAndMaybeAddMove(x, y, x + 1, y - 2);
-  CheckNewSquareAndMaybeAddMove(x, y, x - 1, y - 2);
-  CheckNewSquareAndMaybeAddMove(x, y, x - 2, y + 1);
-  CheckNewSquareAndMaybeAddMove(x, y, x - 2, y - 1);
-  CheckNewSquareAndMaybeAddMove(x, y, x + 1, y + 2);
-  CheckNewSquareAndMaybeAddMove(x, y, x - 1, y + 2);
-}
-
-void MoveCalculator::HandleBishopMoves(size_t x, size_t y) {
-  HandleMovesHelper(x, y, 1, 1);
-  HandleMovesHelper(x, y, 1, -1);
-  HandleMovesHelper(x, y, -1, 1);
-  HandleMovesHelper(x, y, -1, -1);
+template <bool White>
+void MoveGenerator<White>::HandleKnightMoves(size_t square) {
+  AddMovesToSquares(square, KnightAttacks(square));
 }
 
-void MoveCalculator::HandleRookMoves(size_t x, size_t y) {
-  HandleMovesHelper(x, y, 1, 0);
-  HandleMovesHelper(x, y, 0, 1);
-  HandleMovesHelper(x, y, -1, 0);
-  HandleMovesHelper(x, y, 0, -1);
+template <bool White>
+void MoveGenerator<White>::HandleBishopMoves(size_t square) {
+  AddMovesToSquares(square, BishopAttacks(square, board_.Occupancy()));
 }
 
-void MoveCalculator::HandleQueenMoves(size_t x, size_t y) {
-  HandleBishopMoves(x, y);
-  HandleRookMoves(x, y);
+template <bool White>
+void MoveGenerator<White>::HandleRookMoves(size_t square) {
+  AddMovesToSquares(square, RookAttacks(square, board_.Occupancy()));
 }
 
-void MoveCalculator::HandleKingMoves(size_t x, size_t y) {
-  CheckNewSquareAndMaybeAddMove(x, y, x + 1, y);
-  CheckNewSquareAndMaybeAddMove(x, y, x + 1, y - 1);
-  CheckNewSquareAndMaybeAddMove(x, y, x, y - 1);
-  CheckNewSquareAndMaybeAddMove(x, y, x - 1, y - 1);
-  CheckNewSquareAndMaybeAddMove(x, y, x - 1, y);
-  CheckNewSquareAndMaybeAddMove(x, y, x - 1, y + 1);
-  CheckNewSquareAndMaybeAddMove(x, y, x, y + 1);
-  CheckNewSquareAndMaybeAddMove(x, y, x + 1, y + 1);
-  HandleCastlings(x, y);
+template <bool White>
+void MoveGenerator<White>::HandleQueenMoves(size_t square) {
+  AddMovesToSquares(square, QueenAttacks(square, board_.Occupancy()));
 }
 
-void MoveCalculator::AddCastling(bool white_king, bool king_side) {
-  Board copy = *board_;
-  const size_t rank = white_king ? 0u : 7u;
-  const size_t king_old_x = 4u;
-  const size_t king_new_x = king_side ? 6u : 2u;
-  const size_t rook_old_x = king_side ? 7u : 0u;
-  const size_t rook_new_x = king_side ? 5u : 3u;
-  copy.at(king_old_x, rank) = 0x0;
-  copy.at(king_new_x, rank) = white_king ? 'K' : 'k';
-  copy.at(rook_old_x, rank) = 0x0;
-  copy.at(rook_new_x, rank) = white_king ? 'R' : 'r';
-  copy.SetKingPosition(white_king, king_new_x, rank);
-  copy.ChangeSideToMove();
-  copy.IncrementHalfMoveClock();
-  copy.InvalidateEnPassantTargetSquare();
-  if (white_king) {
-    copy.UnsetCanCastle(Castling::Q);
-    copy.UnsetCanCastle(Castling::K);
-  } else {
-    copy.UnsetCanCastle(Castling::q);
-    copy.UnsetCanCastle(Castling::k);
-    copy.IncrementFullMoveNumber();
-  }
-  moves_.push_back({std::move(copy), king_old_x, rank, king_new_x, rank, '\0', false});
-}
-
-bool MoveCalculator::CanCastle(bool white_king, bool king_side) const {
-  if (white_king) {
-    if (!board_->CanCastle(king_side ? Castling::K : Castling::Q)) {
-      return false;
-    }
-  } else {
-    if (!board_->CanCastle(king_side ? Castling::k : Castling::q)) {
-      return false;
+template <bool White>
+void MoveGenerator<White>::HandleKingMoves(size_t square) {
+  // King must not step onto an attacked square; it's removed from occupancy
+  // so that it doesn't shield squares behind it from a checking slider.
+  const Bitboard opponent = board_.Occupancy(!White);
+  const Bitboard occupancy = board_.Occupancy() ^ SquareBit(square);
+  Bitboard squares = KingAttacks(square) & ModeTargets();
+  while (squares) {
+    const size_t to = PopLowestSquare(squares);
+    if (board_.AttackersTo<!White>(to, occupancy) == 0u) {
+      AddMove(Move(square, to, (opponent & SquareBit(to)) ? Move::CAPTURE : Move::QUIET));
     }
   }
-  const size_t rank = white_king ? 0u : 7u;
-  const size_t rook_x = king_side ? 7u : 0u;
-  if (board_->at(rook_x, rank) != (white_king ? 'R' : 'r')) {
-    return false;
+  if (checkers_ == 0u && GeneratesQuiets()) {
+    HandleCastlings(square);
   }
+}
+
+template <bool White>
+template <bool KingSide>
+bool MoveGenerator<White>::CanCastle() const {
+  constexpr Castling castling =
+    White ? (KingSide ? Castling::K : Castling::Q) : (KingSide ? Castling::k : Castling::q);
+  constexpr size_t rank = White ? 0u : 7u;
+  constexpr size_t king_square = rank * 8u + 4u;
+  constexpr size_t rook_square = rank * 8u + (KingSide ? 7u : 0u);
+  // Squares between king and rook have to be empty, squares the king passes
+  // over mustn't be attacked.
+  constexpr Bitboard empty_squares =
+    KingSide ? Bitboard(0x60) << (rank * 8u) : Bitboard(0x0e) << (rank * 8u);
+  constexpr size_t first_square = KingSide ? king_square + 1u : king_square - 1u;
+  constexpr size_t second_square = KingSide ? king_square + 2u : king_square - 2u;
 
-  const size_t king_staring_x = 4u;
-  const int offset = king_side ? 1 : -1;
-  const size_t first_x = king_staring_x + offset;
-  const size_t second_x = first_x + offset;
-  if (board_->at(first_x, rank) || board_->at(second_x, rank)) {
+  if (!board_.CanCastle(castling)) {
     return false;
   }
-  if (!king_side) {
-    const size_t third_x = second_x + offset;
-    if (board_->at(third_x, rank)) {
-      return false;
-    }
-  }
-  if (board_->IsKingInCheck(white_king)) {
+  if (!(board_.Figures(White, ROOK) & SquareBit(rook_square))) {
     return false;
   }
-  Board copy = *board_;
-  assert(copy.at(king_staring_x, rank) == (white_king ? 'K' : 'k'));
-  copy.at(king_staring_x, rank) = '\0';
-  copy.at(first_x, rank) = white_king ? 'K' : 'k';
-  copy.SetKingPosition(white_king, first_x, rank);
-  copy.ChangeSideToMove();
-  if (copy.IsKingInCheck(white_king)) {
+  if (board_.Occupancy() & empty_squares) {
     return false;
   }
-  copy.at(first_x, rank) = '\0';
-  copy.at(second_x, rank) = white_king ? 'K' : 'k';
-  copy.SetKingPosition(white_king, second_x, rank);
-  if (copy.IsKingInCheck(white_king)) {
+  assert(board_.Figures(White, KING) & SquareBit(king_square));
+  if (board_.IsSquareAttacked<!White>(first_square) ||
+      board_.IsSquareAttacked<!White>(second_square)) {
     return false;
   }
   return true;
 }
 
-void MoveCalculator::HandleCastlings(size_t x, size_t y) {
-  const bool white_to_move = board_->WhiteToMove();
-  if (white_to_move) {
-    if (x != 4u || y != 0) {
-      return;
-    }
+template <bool White>
+void MoveGenerator<White>::HandleCastlings(size_t square) {
+  if (square != SquareIndex(4u, White ? 0u : 7u)) {
+    return;
+  }
+  if (CanCastle<true>()) {
+    AddMove(Move(square, square + 2u, Move::KING_SIDE_CASTLING));
+  }
+  if (CanCastle<false>()) {
+    AddMove(Move(square, square - 2u, Move::QUEEN_SIDE_CASTLING));
+  }
+}
+
+void Generate(const Board& board, GenerationMode mode, MoveList& moves) {
+  if (board.WhiteToMove()) {
+    MoveGenerator<true>(board, mode, &moves).GenerateAll();
   } else {
-    if (x != 4u || y != 7) {
-      return;
-    }
+    MoveGenerator<false>(board, mode, &moves).GenerateAll();
   }
-  if (CanCastle(white_to_move, true)) {
-    AddCastling(white_to_move, true);
+}
+
+}  // unnamed namespace
+
+
+void MoveCalculator::CalculateAllMoves(const Board& board, MoveList& moves) const {
+  Generate(board, GenerationMode::ALL, moves);
+}
+
+void MoveCalculator::GenerateCaptures(const Board& board, MoveList& moves) const {
+  Generate(board, GenerationMode::CAPTURES, moves);
+}
+
+void MoveCalculator::GenerateQuiets(const Board& board, MoveList& moves) const {
+  Generate(board, GenerationMode::QUIETS, moves);
+}
+
+MoveList MoveCalculator::CalculateAllMoves(const std::string& fen) const {
+  Board board(fen);
+  return CalculateAllMoves(board);
+}
+
+MoveList MoveCalculator::CalculateAllMoves(const Board& board) const {
+  MoveList moves;
+  CalculateAllMoves(board, moves);
+  return moves;
+}
+
+MoveList MoveCalculator::GenerateCaptures(const Board& board) const {
+  MoveList moves;
+  GenerateCaptures(board, moves);
+  return moves;
+}
+
+MoveList MoveCalculator::GenerateQuiets(const Board& board) const {
+  MoveList moves;
+  GenerateQuiets(board, moves);
+  return moves;
+}
+
+bool MoveCalculator::HasAnyLegalMove(const Board& board) const {
+  if (board.WhiteToMove()) {
+    return MoveGenerator<true>(board, GenerationMode::ALL, nullptr).GenerateAny();
   }
-  if (CanCastle(white_to_move, false)) {
-    AddCastling(white_to_move, false);
+  return MoveGenerator<false>(board, GenerationMode::ALL, nullptr).GenerateAny();
+}
+
+size_t MoveCalculator::CountLegalMoves(const Board& board) const {
+  if (board.WhiteToMove()) {
+    MoveGenerator<true> generator(board, GenerationMode::ALL, nullptr);
+    generator.GenerateAll();
+    return generator.Count();
+  }
+  MoveGenerator<false> generator(board, GenerationMode::ALL, nullptr);
+  generator.GenerateAll();
+  return generator.Count();
+}
+
+bool MoveCalculator::IsLegal(const Board& board, Move move) const {
+  if (move.IsNull()) {
+    return false;
+  }
+  if (!(board.Occupancy(board.WhiteToMove()) & SquareBit(move.From()))) {
+    return false;
+  }
+  MoveList moves;
+  if (board.WhiteToMove()) {
+    MoveGenerator<true>(board, GenerationMode::ALL, &moves).GenerateForSquare(move.From());
+  } else {
+    MoveGenerator<false>(board, GenerationMode::ALL, &moves).GenerateForSquare(move.From());
+  }
+  for (const auto& m: moves) {
+    if (m == move) {
+      return true;
+    }
   }
+  return false;
 }
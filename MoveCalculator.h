@@ -2,50 +2,32 @@
 #define MOVE_CALCULATOR_H_
 
 #include <iostream>
-#include <vector>
 
 #include "Board.h"
+#include "Move.h"
 
-struct Move {
-  Move(Board&& b, size_t ox, size_t oy, size_t nx, size_t ny, char p, bool fc) :
-    board(std::move(b)), old_x(ox), old_y(oy), new_x(nx), new_y(ny), promotion_to(p), figure_captured(fc) {}
-  Move(Board& b, size_t ox, size_t oy, size_t nx, size_t ny, char p, bool fc) :
-    board(b), old_x(ox), old_y(oy), new_x(nx), new_y(ny), promotion_to(p), figure_captured(fc) {}
-
-  const Board board;
-  const size_t old_x;
-  const size_t old_y;
-  const size_t new_x;
-  const size_t new_y;
-  const char promotion_to{0x0};
-  const bool figure_captured{false};
-};
-
-std::ostream& operator<<(std::ostream& os, const Move& move);
-
+// Legal move generation. Calls keep all their state on the stack, so one
+// instance may be used recursively and from many threads at once, as long
+// as the threads work on different Board objects.
 class MoveCalculator {
  public:
-  std::vector<Move> CalculateAllMoves(const Board& board);
-  std::vector<Move> CalculateAllMoves(const std::string& fen);
-
- private:
-  void HandlePawnMoves(size_t x, size_t y);
-  void HandleKnightMoves(size_t x, size_t y);
-  void HandleBishopMoves(size_t x, size_t y);
-  void HandleRookMoves(size_t x, size_t y);
-  void HandleQueenMoves(size_t x, size_t y);
-  void HandleKingMoves(size_t x, size_t y);
-  void HandleCastlings(size_t x, size_t y);
-  bool CanCastle(bool white_king, bool king_side) const;
-  void AddCastling(bool white_king, bool king_side);
-  void CheckNewSquareAndMaybeAddMove(size_t old_x, size_t old_y, int new_x, int new_y);
-  void MaybeAddMove(size_t old_x, size_t old_y, size_t new_x, size_t new_y, bool promotion = false);
-  void HandleMovesHelper(size_t x, size_t y, int x_offset, int y_offset);
-  void UpdateCastlings(Board& copy, char figure, size_t old_x, size_t old_y) const;
-  void UpdateEnPassantTargetSquare(Board& copy, char figure, size_t old_x, size_t old_y, size_t new_y) const;
-
-  const Board* board_{nullptr};
-  std::vector<Move> moves_;
+  // Legal moves are appended to given list.
+  void CalculateAllMoves(const Board& board, MoveList& moves) const;
+  // Captures (en passant included) and all promotions.
+  void GenerateCaptures(const Board& board, MoveList& moves) const;
+  // Everything CalculateAllMoves() returns apart from GenerateCaptures() moves.
+  void GenerateQuiets(const Board& board, MoveList& moves) const;
+  MoveList CalculateAllMoves(const Board& board) const;
+  MoveList CalculateAllMoves(const std::string& fen) const;
+  MoveList GenerateCaptures(const Board& board) const;
+  MoveList GenerateQuiets(const Board& board) const;
+  // Tells whether the move is one of the legal moves in given position.
+  // Only moves of the figure standing on move's origin square are generated.
+  bool IsLegal(const Board& board, Move move) const;
+  // Both stop short of building the list of moves; the former returns
+  // as soon as the first legal move is found.
+  bool HasAnyLegalMove(const Board& board) const;
+  size_t CountLegalMoves(const Board& board) const;
 };
 
 #endif  // MOVE_CALCULATOR_H_
@@ -3,9 +3,12 @@
 #include "utils/Test.h"
 
 #include <cassert>
+#include <cctype>
 #include <iostream>
 #include <sstream>
+#include <thread>
 #include <utility>
+#include <vector>
 
 
 namespace {
@@ -13,7 +16,7 @@ namespace {
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-function"
 
-std::ostream& operator<<(std::ostream& os, const std::vector<Move>& moves) {
+std::ostream& operator<<(std::ostream& os, const MoveList& moves) {
   for (const auto& move: moves) {
     os << move << std::endl;
   }
@@ -28,20 +31,33 @@ std::ostream& operator<<(std::ostream& os, const std::vector<Move>& moves) {
   const size_t new_x = str[2] - 'a'; \
   const size_t new_y = str[3] - '1';
 
-bool operator==(const Move& m1, const Move& m2) {
-  return m1.old_x == m2.old_x &&
-         m1.old_y == m2.old_y &&
-         m1.new_x == m2.new_x &&
-         m1.new_y == m2.new_y &&
-         m1.figure_captured == m2.figure_captured &&
-         m1.promotion_to == m2.promotion_to;
+size_t CountLeaves(const MoveCalculator& calculator, Board& board, unsigned depth) {
+  if (depth == 1u) {
+    return calculator.CountLegalMoves(board);
+  }
+  MoveList moves;
+  calculator.CalculateAllMoves(board, moves);
+  size_t leaves = 0u;
+  for (const auto& move: moves) {
+    const UndoInfo undo = board.MakeMove(move);
+    leaves += CountLeaves(calculator, board, depth - 1);
+    board.UnmakeMove(move, undo);
+  }
+  return leaves;
+}
+
+bool MovesMatch(const Move& m1, const Move& m2) {
+  return m1.From() == m2.From() &&
+         m1.To() == m2.To() &&
+         m1.IsCapture() == m2.IsCapture() &&
+         m1.PromotionTo() == m2.PromotionTo();
 }
 
 bool MovesContainMove(
-    const std::vector<Move>& moves,
+    const MoveList& moves,
     const Move& move) {
   for (const auto& m: moves) {
-    if (m == move) {
+    if (MovesMatch(m, move)) {
       return true;
     }
   }
@@ -50,18 +66,18 @@ bool MovesContainMove(
 
 bool MovesAreEqual(const Move& move, const std::string& move_str) {
   COORDINATES_FROM_STRING(move_str);
-  return move.old_x == old_x && move.old_y == old_y &&
-         move.new_x == new_x && move.new_y == new_y;
+  return move.OldX() == old_x && move.OldY() == old_y &&
+         move.NewX() == new_x && move.NewY() == new_y;
 }
 
 bool MovesContainMove(
-    const std::vector<Move>& moves,
+    const MoveList& moves,
     const std::string& move_str,
     bool figure_captured = false,
     char promotion_to = 0x0) {
   for (const auto& move: moves) {
     if (MovesAreEqual(move, move_str) &&
-        move.promotion_to == promotion_to) {
+        move.PromotionTo() == toupper(promotion_to)) {
       return true;
     }
   }
@@ -72,7 +88,7 @@ bool MovesContainMove(
   VerifyMovesWithoutCapture(moves, old_square, new_squares)
 
 void VerifyMovesWithoutCapture(
-    const std::vector<Move>& moves,
+    const MoveList& moves,
     const std::string& old_square,
     const std::string& new_squares) {
   VERIFY_EQUALS(new_squares.length() % 2, 0u);
@@ -92,30 +108,31 @@ Move CreateMoveFromString(const std::string& str) {
   const size_t new_x = str[3] - 'a';
   const size_t new_y = str[4] - '1';
   const bool figure_captured = (str[2] == 'x');
-  char promotion_to = 0x0;
+  const size_t from = old_y * 8u + old_x;
+  const size_t to = new_y * 8u + new_x;
   if (str.length() > 5u) {
     switch (str[5]) {
       case 'Q':
       case 'q':
+        return Move::Promotion(from, to, QUEEN, figure_captured);
       case 'R':
       case 'r':
+        return Move::Promotion(from, to, ROOK, figure_captured);
       case 'B':
       case 'b':
+        return Move::Promotion(from, to, BISHOP, figure_captured);
       case 'N':
       case 'n':
-        promotion_to = str[5];
-        break;
+        return Move::Promotion(from, to, KNIGHT, figure_captured);
       default:
         assert(!"Unexpected char");
         break;
     }
   }
-  Board fake_board("4K1k1/8/8/8/8/8/8/8 w - - 0 1");
-  Move result({std::move(fake_board), old_x, old_y, new_x, new_y, promotion_to, figure_captured});
-  return result;
+  return Move(from, to, figure_captured ? Move::CAPTURE : Move::QUIET);
 }
 
-void VerifyMoves(const std::vector<Move>& moves, const std::string& list) {
+void VerifyMoves(const MoveList& moves, const std::string& list) {
   std::stringstream ss(list);
   std::string move_str;
   while(getline(ss, move_str, ';')) {
@@ -124,17 +141,17 @@ void VerifyMoves(const std::vector<Move>& moves, const std::string& list) {
   }
 }
 
-Board FindBoardForMove(const std::vector<Move>& moves, const std::string move) {
+Board FindBoardForMove(const Board& board, const MoveList& moves, const std::string move) {
   COORDINATES_FROM_STRING(move);
   char promotion_to = 0x0;
   if (move.length() == 5u) {
-    promotion_to = move[4u];
+    promotion_to = toupper(move[4u]);
   }
   for (const auto& m: moves) {
-    if (m.old_x == old_x && m.old_y == old_y &&
-        m.new_x == new_x && m.new_y == new_y &&
-        m.promotion_to == promotion_to) {
-      return m.board;
+    if (m.OldX() == old_x && m.OldY() == old_y &&
+        m.NewX() == new_x && m.NewY() == new_y &&
+        m.PromotionTo() == promotion_to) {
+      return board.BoardAfterMove(m);
     }
   }
   NOT_REACHED(move);
@@ -315,7 +332,7 @@ TEST_PROCEDURE(MoveCalculator_full_move_number) {
     auto moves = calculator.CalculateAllMoves(board);
     VERIFY_EQUALS(moves.size(), 20u);
     for (const auto& move: moves) {
-      VERIFY_EQUALS(move.board.FullMoveNumber(), 7u) << "failed for move: " << move;
+      VERIFY_EQUALS(board.BoardAfterMove(move).FullMoveNumber(), 7u) << "failed for move: " << move;
     }
   }
   {
@@ -324,7 +341,7 @@ TEST_PROCEDURE(MoveCalculator_full_move_number) {
     auto moves = calculator.CalculateAllMoves(board);
     VERIFY_EQUALS(moves.size(), 20u);
     for (const auto& move: moves) {
-      VERIFY_EQUALS(move.board.FullMoveNumber(), 8u) << "failed for move: " << move;
+      VERIFY_EQUALS(board.BoardAfterMove(move).FullMoveNumber(), 8u) << "failed for move: " << move;
     }
   }
   {
@@ -333,7 +350,7 @@ TEST_PROCEDURE(MoveCalculator_full_move_number) {
     auto moves = calculator.CalculateAllMoves(board);
     VERIFY_EQUALS(moves.size(), 23u);
     for (const auto& move: moves) {
-      VERIFY_EQUALS(move.board.FullMoveNumber(), 99u) << "failed for move: " << move;
+      VERIFY_EQUALS(board.BoardAfterMove(move).FullMoveNumber(), 99u) << "failed for move: " << move;
     }
   }
   {
@@ -342,7 +359,7 @@ TEST_PROCEDURE(MoveCalculator_full_move_number) {
     auto moves = calculator.CalculateAllMoves(board);
     VERIFY_EQUALS(moves.size(), 23u);
     for (const auto& move: moves) {
-      VERIFY_EQUALS(move.board.FullMoveNumber(), 100u) << "failed for move: " << move;
+      VERIFY_EQUALS(board.BoardAfterMove(move).FullMoveNumber(), 100u) << "failed for move: " << move;
     }
   }
   TEST_END
@@ -402,7 +419,7 @@ TEST_PROCEDURE(MoveCalculator_half_move_clock) {
       if (!IsMoveInList(move, moves_reseting_hmc)) {
         expected_hmc = incremented_hmc;
       }
-      VERIFY_EQUALS(move.board.HalfMoveClock(), expected_hmc) << "failed for fen \"" << fen << "\" and move " << move;
+      VERIFY_EQUALS(board.BoardAfterMove(move).HalfMoveClock(), expected_hmc) << "failed for fen \"" << fen << "\" and move " << move;
     }
   }
   TEST_END
@@ -429,8 +446,9 @@ TEST_PROCEDURE(MoveCalculator_castlings_reset) {
   MoveCalculator calculator;
 
   for (const auto&[fen, move, K, Q, k, q]: cases) {
-    auto moves = calculator.CalculateAllMoves(fen);
-    Board board_after_move = FindBoardForMove(moves, move);
+    Board board(fen);
+    auto moves = calculator.CalculateAllMoves(board);
+    Board board_after_move = FindBoardForMove(board, moves, move);
     VERIFY_EQUALS(board_after_move.CanCastle(Castling::K), K) << "failed for fen " << fen;
     VERIFY_EQUALS(board_after_move.CanCastle(Castling::Q), Q) << "failed for fen " << fen;
     VERIFY_EQUALS(board_after_move.CanCastle(Castling::k), k) << "failed for fen " << fen;
@@ -456,8 +474,9 @@ TEST_PROCEDURE(MoveCalculator_figures_placement_after_move) {
   MoveCalculator calculator;
 
   for (const auto&[fen, move, placement_after_move]: cases) {
-    auto moves = calculator.CalculateAllMoves(fen);
-    Board board_after_move = FindBoardForMove(moves, move);
+    Board board(fen);
+    auto moves = calculator.CalculateAllMoves(board);
+    Board board_after_move = FindBoardForMove(board, moves, move);
     const std::string new_fen = placement_after_move + " w - - 0 1";
     Board expected_board(new_fen);
     for (size_t x = 0; x < 8u; ++x) {
@@ -487,7 +506,7 @@ TEST_PROCEDURE(MoveCalculator_side_to_move_after_move) {
     const bool expected_side_to_move = !board.WhiteToMove();
     auto moves = calculator.CalculateAllMoves(fen);
     for (const auto& move: moves) {
-      VERIFY_EQUALS(move.board.WhiteToMove(), expected_side_to_move) << "failed for fen \"" << fen << "\" and move " << move;
+      VERIFY_EQUALS(board.BoardAfterMove(move).WhiteToMove(), expected_side_to_move) << "failed for fen \"" << fen << "\" and move " << move;
     }
   }
   TEST_END
@@ -511,12 +530,13 @@ TEST_PROCEDURE(MoveCalculator_en_passant_target_square_after_move) {
   MoveCalculator calculator;
 
   for (const auto& [fen, move_str, en_passant_target_square]: cases) {
-    auto moves = calculator.CalculateAllMoves(fen);
+    Board board(fen);
+    auto moves = calculator.CalculateAllMoves(board);
     for (const auto& move: moves) {
       if (MovesAreEqual(move, move_str)) {
-        VERIFY_EQUALS(move.board.EnPassantTargetSquare(), Square(en_passant_target_square)) << "failed for fen " << fen;
+        VERIFY_EQUALS(board.BoardAfterMove(move).EnPassantTargetSquare(), Square(en_passant_target_square)) << "failed for fen " << fen;
       } else {
-        VERIFY_TRUE(move.board.EnPassantTargetSquare().IsInvalid())  << "failed for fen \"" << fen << "\" and move " << move;
+        VERIFY_TRUE(board.BoardAfterMove(move).EnPassantTargetSquare().IsInvalid())  << "failed for fen \"" << fen << "\" and move " << move;
       }
     }
   }
@@ -574,4 +594,105 @@ TEST_PROCEDURE(MoveCalculator_castlings) {
   TEST_END
 }
 
+TEST_PROCEDURE(MoveCalculator_captures_and_quiets) {
+  TEST_START
+  const std::vector<std::string> fens = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 b kq - 0 1",
+    "8/8/5K2/8/2pP4/5k2/8/8 b - d3 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8"
+  };
+  for (const auto& fen: fens) {
+    Board board(fen);
+    MoveCalculator calculator;
+    const MoveList all = calculator.CalculateAllMoves(board);
+    const MoveList captures = calculator.GenerateCaptures(board);
+    const MoveList quiets = calculator.GenerateQuiets(board);
+    VERIFY_EQUALS(captures.size() + quiets.size(), all.size()) << "failed for fen: " << fen;
+    for (const auto& move: captures) {
+      VERIFY_TRUE(move.IsCapture() || move.IsPromotion()) << fen << " " << move;
+      VERIFY_TRUE(MovesContainMove(all, move)) << fen << " " << move;
+    }
+    for (const auto& move: quiets) {
+      VERIFY_FALSE(move.IsCapture() || move.IsPromotion()) << fen << " " << move;
+      VERIFY_TRUE(MovesContainMove(all, move)) << fen << " " << move;
+    }
+  }
+  TEST_END
+}
+
+TEST_PROCEDURE(MoveCalculator_gives_check) {
+  TEST_START
+  const std::vector<std::string> fens = {
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "5k2/8/8/8/8/8/8/4K2R w K - 0 1",
+    "8/8/8/k1pP3R/8/8/8/4K3 w - c6 0 1",
+    "8/1P6/8/8/8/8/8/1k2K3 w - - 0 1",
+    "4k3/8/8/8/8/8/4N3/4R1K1 w - - 0 1"
+  };
+  size_t checks = 0u;
+  for (const auto& fen: fens) {
+    Board board(fen);
+    MoveCalculator calculator;
+    for (const auto& move: calculator.CalculateAllMoves(board)) {
+      const bool gives_check = board.BoardAfterMove(move).IsKingInCheck(!board.WhiteToMove());
+      VERIFY_EQUALS(board.GivesCheck(move), gives_check) << fen << " " << move;
+      checks += gives_check;
+    }
+  }
+  VERIFY_TRUE(checks > 0u);
+  TEST_END
+}
+
+TEST_PROCEDURE(MoveCalculator_count_legal_moves) {
+  TEST_START
+  const std::vector<std::string> fens = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "8/8/5K2/8/2pP4/5k2/8/8 b - d3 0 1",
+    "rnb1kbnr/pppp1ppp/8/4p3/6Pq/5P2/PPPPP2P/RNBQKBNR w KQkq - 1 3",
+    "7k/5Q2/6K1/8/8/8/8/8 b - - 0 1",
+    "4k3/4r3/8/8/8/8/3PPP2/3QKB2 w - - 0 1"
+  };
+  for (const auto& fen: fens) {
+    Board board(fen);
+    MoveCalculator calculator;
+    const MoveList moves = calculator.CalculateAllMoves(board);
+    VERIFY_EQUALS(calculator.CountLegalMoves(board), moves.size()) << "failed for fen: " << fen;
+    VERIFY_EQUALS(calculator.HasAnyLegalMove(board), !moves.empty()) << "failed for fen: " << fen;
+  }
+  TEST_END
+}
+
+TEST_PROCEDURE(MoveCalculator_shared_between_threads) {
+  TEST_START
+  const std::vector<std::pair<std::string, size_t>> cases = {
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 8902u},
+    {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 97862u},
+    {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 2812u},
+    {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 9467u}
+  };
+  const MoveCalculator calculator{};
+  std::vector<size_t> leaves(cases.size(), 0u);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < cases.size(); ++i) {
+    threads.emplace_back([&, i]() {
+      Board board(cases[i].first);
+      leaves[i] = CountLeaves(calculator, board, 3u);
+    });
+  }
+  for (auto& thread: threads) {
+    thread.join();
+  }
+  for (size_t i = 0; i < cases.size(); ++i) {
+    VERIFY_EQUALS(leaves[i], cases[i].second) << "failed for fen: " << cases[i].first;
+  }
+  TEST_END
+}
+
 }  // unnamed namespace
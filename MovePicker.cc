@@ -0,0 +1,103 @@
+#include "MovePicker.h"
+
+#include <utility>
+
+MovePicker::MovePicker(const Board& board, Move hash_move, Move killer1, Move killer2)
+  : board_(board),
+    hash_move_(hash_move),
+    killers_{{killer1, killer2}} {
+}
+
+Move MovePicker::NextMove() {
+  switch (stage_) {
+    case Stage::HASH_MOVE:
+      stage_ = Stage::GENERATE_CAPTURES;
+      if (calculator_.IsLegal(board_, hash_move_)) {
+        return hash_move_;
+      }
+      // fall through
+    case Stage::GENERATE_CAPTURES:
+      calculator_.GenerateCaptures(board_, captures_);
+      ScoreCaptures();
+      current_ = 0u;
+      stage_ = Stage::CAPTURES;
+      // fall through
+    case Stage::CAPTURES:
+      while (current_ < captures_.size()) {
+        const Move move = PickBestCapture();
+        if (move != hash_move_) {
+          return move;
+        }
+      }
+      stage_ = Stage::KILLER1;
+      // fall through
+    case Stage::KILLER1:
+      stage_ = Stage::KILLER2;
+      if (IsValidKiller(killers_[0])) {
+        return killers_[0];
+      }
+      // fall through
+    case Stage::KILLER2:
+      stage_ = Stage::GENERATE_QUIETS;
+      if (killers_[1] != killers_[0] && IsValidKiller(killers_[1])) {
+        return killers_[1];
+      }
+      // fall through
+    case Stage::GENERATE_QUIETS:
+      calculator_.GenerateQuiets(board_, quiets_);
+      current_ = 0u;
+      stage_ = Stage::QUIETS;
+      // fall through
+    case Stage::QUIETS:
+      while (current_ < quiets_.size()) {
+        const Move move = quiets_[current_++];
+        if (!IsAlreadyReturned(move)) {
+          return move;
+        }
+      }
+      stage_ = Stage::DONE;
+      // fall through
+    case Stage::DONE:
+      break;
+  }
+  return Move();
+}
+
+void MovePicker::ScoreCaptures() {
+  for (size_t i = 0; i < captures_.size(); ++i) {
+    const Move move = captures_[i];
+    const FigureType victim = (move.IsCapture() && !move.IsEnPassant()) ?
+      TypeOf(board_.PieceAt(move.To())) : PAWN;
+    const FigureType attacker = TypeOf(board_.PieceAt(move.From()));
+    int score = victim * FIGURE_TYPES - attacker;
+    if (move.IsPromotion()) {
+      score += move.PromotionFigure() * FIGURE_TYPES;
+      if (!move.IsCapture()) {
+        score -= FIGURE_TYPES;
+      }
+    }
+    capture_scores_[i] = score;
+  }
+}
+
+Move MovePicker::PickBestCapture() {
+  size_t best = current_;
+  for (size_t i = current_ + 1; i < captures_.size(); ++i) {
+    if (capture_scores_[i] > capture_scores_[best]) {
+      best = i;
+    }
+  }
+  std::swap(captures_[current_], captures_[best]);
+  std::swap(capture_scores_[current_], capture_scores_[best]);
+  return captures_[current_++];
+}
+
+bool MovePicker::IsAlreadyReturned(Move move) const {
+  return move == hash_move_ || move == killers_[0] || move == killers_[1];
+}
+
+bool MovePicker::IsValidKiller(Move move) {
+  return !move.IsNull() && move != hash_move_ &&
+         !move.IsCapture() && !move.IsPromotion() &&
+         calculator_.IsLegal(board_, move);
+}
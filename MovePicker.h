@@ -0,0 +1,53 @@
+#ifndef MOVE_PICKER_H_
+#define MOVE_PICKER_H_
+
+#include <array>
+
+#include "Board.h"
+#include "Move.h"
+#include "MoveCalculator.h"
+
+// Hands out legal moves of a position one by one, in the order in which
+// they're most likely to cause a cutoff: hash move, captures (most valuable
+// victim first, least valuable attacker on ties), killers and finally quiet
+// moves. Every stage is generated only after the previous one is exhausted,
+// so a search which cuts off early doesn't pay for generating the rest.
+class MovePicker {
+ public:
+  MovePicker(const Board& board,
+             Move hash_move = Move(),
+             Move killer1 = Move(),
+             Move killer2 = Move());
+
+  // Returns null move once all moves have been returned.
+  Move NextMove();
+
+ private:
+  enum class Stage {
+    HASH_MOVE,
+    GENERATE_CAPTURES,
+    CAPTURES,
+    KILLER1,
+    KILLER2,
+    GENERATE_QUIETS,
+    QUIETS,
+    DONE
+  };
+
+  void ScoreCaptures();
+  Move PickBestCapture();
+  bool IsAlreadyReturned(Move move) const;
+  bool IsValidKiller(Move move);
+
+  const Board& board_;
+  MoveCalculator calculator_;
+  Stage stage_{Stage::HASH_MOVE};
+  const Move hash_move_;
+  const std::array<Move, 2u> killers_;
+  MoveList captures_;
+  std::array<int, MoveList::CAPACITY> capture_scores_;
+  MoveList quiets_;
+  size_t current_{0u};
+};
+
+#endif  // MOVE_PICKER_H_
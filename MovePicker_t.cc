@@ -0,0 +1,129 @@
+/* Component tests for class MovePicker */
+
+#include <string>
+#include <vector>
+
+#include "Board.h"
+#include "MoveCalculator.h"
+#include "MovePicker.h"
+#include "utils/Test.h"
+
+
+namespace {
+
+size_t S(const char* square) {
+  return SquareIndex(square[0] - 'a', square[1] - '1');
+}
+
+std::vector<Move> PickAll(MovePicker& picker) {
+  std::vector<Move> result;
+  for (Move move = picker.NextMove(); !move.IsNull(); move = picker.NextMove()) {
+    result.push_back(move);
+  }
+  return result;
+}
+
+size_t CountMove(const std::vector<Move>& moves, Move move) {
+  size_t count = 0u;
+  for (const auto& m: moves) {
+    if (m == move) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+// ===============================================================
+
+TEST_PROCEDURE(MovePicker_returns_every_legal_move_once) {
+  TEST_START
+  const std::vector<std::string> fens = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "7k/8/8/8/8/8/8/K6R b - - 0 1",
+  };
+  for (const auto& fen: fens) {
+    Board board(fen);
+    MoveCalculator calculator;
+    const MoveList expected = calculator.CalculateAllMoves(board);
+    // Hash move and killers are taken from the list itself, so they are legal
+    // and mustn't be returned twice.
+    const Move hash_move = expected.empty() ? Move() : expected[expected.size() - 1];
+    const Move killer = expected.empty() ? Move() : expected[0];
+    MovePicker picker(board, hash_move, killer, killer);
+    const std::vector<Move> picked = PickAll(picker);
+    VERIFY_EQUALS(picked.size(), expected.size()) << fen;
+    for (const auto& move: expected) {
+      VERIFY_EQUALS(CountMove(picked, move), 1u) << fen << " " << move;
+    }
+    VERIFY_TRUE(picker.NextMove().IsNull());
+  }
+  TEST_END
+}
+
+TEST_PROCEDURE(MovePicker_hash_move_goes_first) {
+  TEST_START
+  Board board("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+  {
+    const Move hash_move(S("g1"), S("f3"));
+    MovePicker picker(board, hash_move);
+    VERIFY_TRUE(picker.NextMove() == hash_move);
+    const std::vector<Move> rest = PickAll(picker);
+    VERIFY_EQUALS(rest.size(), 19u);
+    VERIFY_EQUALS(CountMove(rest, hash_move), 0u);
+  }
+  {
+    // Hash move which isn't legal in this position is ignored.
+    const Move hash_move(S("e2"), S("e5"));
+    MovePicker picker(board, hash_move);
+    const std::vector<Move> moves = PickAll(picker);
+    VERIFY_EQUALS(moves.size(), 20u);
+    VERIFY_EQUALS(CountMove(moves, hash_move), 0u);
+  }
+  TEST_END
+}
+
+TEST_PROCEDURE(MovePicker_captures_are_ordered_by_victim_and_attacker) {
+  TEST_START
+  // Pawn and queen can both capture black queen, queen can capture knight
+  // and pawn can capture rook.
+  Board board("4k3/8/8/2r1q2n/3P4/8/7Q/7K w - - 0 1");
+  MovePicker picker(board);
+  VERIFY_TRUE(picker.NextMove() == Move(S("d4"), S("e5"), Move::CAPTURE));
+  VERIFY_TRUE(picker.NextMove() == Move(S("h2"), S("e5"), Move::CAPTURE));
+  VERIFY_TRUE(picker.NextMove() == Move(S("d4"), S("c5"), Move::CAPTURE));
+  VERIFY_TRUE(picker.NextMove() == Move(S("h2"), S("h5"), Move::CAPTURE));
+  VERIFY_FALSE(picker.NextMove().IsCapture());
+  TEST_END
+}
+
+TEST_PROCEDURE(MovePicker_killers_follow_captures) {
+  TEST_START
+  Board board("4k3/8/8/4q3/3P4/8/8/6NK w - - 0 1");
+  const Move killer1(S("g1"), S("f3"));
+  const Move killer2(S("h1"), S("g2"));
+  // Capture is never returned as a killer.
+  const Move capture_killer(S("d4"), S("e5"), Move::CAPTURE);
+  {
+    MovePicker picker(board, Move(), killer1, killer2);
+    VERIFY_TRUE(picker.NextMove() == capture_killer);
+    VERIFY_TRUE(picker.NextMove() == killer1);
+    VERIFY_TRUE(picker.NextMove() == killer2);
+    const std::vector<Move> rest = PickAll(picker);
+    VERIFY_EQUALS(CountMove(rest, killer1), 0u);
+    VERIFY_EQUALS(CountMove(rest, killer2), 0u);
+  }
+  {
+    MovePicker picker(board, Move(), capture_killer, killer1);
+    VERIFY_TRUE(picker.NextMove() == capture_killer);
+    VERIFY_TRUE(picker.NextMove() == killer1);
+    const std::vector<Move> rest = PickAll(picker);
+    VERIFY_EQUALS(CountMove(rest, capture_killer), 0u);
+    VERIFY_EQUALS(CountMove(rest, killer1), 0u);
+  }
+  TEST_END
+}
+
+}  // unnamed namespace
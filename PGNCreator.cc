@@ -1,7 +1,6 @@
 #include "PGNCreator.h"
 
 #include <cassert>
-#include <cctype>
 #include <sstream>
 #include <vector>
 
@@ -48,24 +47,24 @@ char RankNumberToString(size_t rank) {
 
 std::string DestinationSquareToString(const Move& move) {
   std::string result;
-  result += FileNumberToString(move.new_x);
-  result += RankNumberToString(move.new_y);
+  result += FileNumberToString(move.NewX());
+  result += RankNumberToString(move.NewY());
   return result;
 }
 
-std::vector<Move> FindAllMatchingMoves(
+MoveList FindAllMatchingMoves(
     const Board& board,
     const Move& move_to_match) {
-  std::vector<Move> matching_moves;
-  const char figure = board.at(move_to_match.old_x, move_to_match.old_y);
-  assert(figure);
+  MoveList matching_moves;
+  const Piece piece = board.PieceAt(move_to_match.From());
+  assert(piece != NO_PIECE);
   MoveCalculator calculator;
   auto moves = calculator.CalculateAllMoves(board);
   for (const auto& move: moves) {
-    if (board.at(move.old_x, move.old_y) == figure &&
-        move.promotion_to == move_to_match.promotion_to &&
-        move.new_x == move_to_match.new_x &&
-        move.new_y == move_to_match.new_y) {
+    if (board.PieceAt(move.From()) == piece &&
+        move.PromotionTo() == move_to_match.PromotionTo() &&
+        move.NewX() == move_to_match.NewX() &&
+        move.NewY() == move_to_match.NewY()) {
       matching_moves.push_back(move);
     }
   }
@@ -73,8 +72,7 @@ std::vector<Move> FindAllMatchingMoves(
 }
 
 MoveTypeFlag DetermineMoveType(const Board& board, const Move& move) {
-  const char figure = board.at(move.old_x, move.old_y);
-  assert(figure);
+  assert(board.PieceAt(move.From()) != NO_PIECE);
   auto matching_moves = FindAllMatchingMoves(board, move);
   assert(!matching_moves.empty());
   MoveTypeFlag flags = MoveTypeFlag::NONE;
@@ -84,10 +82,10 @@ MoveTypeFlag DetermineMoveType(const Board& board, const Move& move) {
     size_t number_of_moves_with_matching_file = 0u;
     size_t number_of_moves_with_matching_rank = 0u;
     for (const auto& matching_move: matching_moves) {
-      if (matching_move.old_x == move.old_x) {
+      if (matching_move.OldX() == move.OldX()) {
         ++number_of_moves_with_matching_file;
       }
-      if (matching_move.old_y == move.old_y) {
+      if (matching_move.OldY() == move.OldY()) {
         ++number_of_moves_with_matching_rank;
       }
     }
@@ -103,61 +101,47 @@ MoveTypeFlag DetermineMoveType(const Board& board, const Move& move) {
   return flags;
 }
 
-bool IsCastling(char figure, const Move& move, bool king_side) {
-  if (figure != 'K' && figure != 'k') {
-    return false;
-  }
-  const size_t expected_rank = (figure == 'K' ? 0u : 7u);
-  const size_t expected_source_file = 4u;
-  const size_t expected_destination_file = (king_side ? 6u : 2u);
-  return move.old_x == expected_source_file &&
-         move.new_x == expected_destination_file &&
-         move.new_y == expected_rank;
-}
-
 std::string MoveToString(const Board& board, const Move& move) {
-  const char figure = board.at(move.old_x, move.old_y);
-  assert(figure);
-  if (IsCastling(figure, move, true)) {
+  const Piece piece = board.PieceAt(move.From());
+  assert(piece != NO_PIECE);
+  const bool is_pawn = TypeOf(piece) == PAWN;
+  if (move.GetFlags() == Move::KING_SIDE_CASTLING) {
     return "O-O";
   }
-  if (IsCastling(figure, move, false)) {
+  if (move.GetFlags() == Move::QUEEN_SIDE_CASTLING) {
     return "O-O-O";
   }
   std::string result;
-  if (figure != 'P' && figure != 'p') {
-    result += toupper(figure);
+  if (!is_pawn) {
+    result += PieceChars[MakePiece(true, TypeOf(piece))];
     MoveTypeFlag flags = DetermineMoveType(board, move);
     if (!IsUniqueDestination(flags)) {
       if (IsUniqueSourceFile(flags)) {
-        result += FileNumberToString(move.old_x);
+        result += FileNumberToString(move.OldX());
       } else if (IsUniqueSourceRank(flags)) {
-        result += RankNumberToString(move.old_y);
+        result += RankNumberToString(move.OldY());
       } else {
         assert(flags == MoveTypeFlag::NONE);
-        result += FileNumberToString(move.old_x);
-        result += RankNumberToString(move.old_y);
+        result += FileNumberToString(move.OldX());
+        result += RankNumberToString(move.OldY());
       }
     }
   }
-  if (move.figure_captured) {
-    if (figure == 'P' || figure == 'p') {
-      result += FileNumberToString(move.old_x);
+  if (move.IsCapture()) {
+    if (is_pawn) {
+      result += FileNumberToString(move.OldX());
     }
     result += 'x';
   }
   result += DestinationSquareToString(move);
-  if (move.promotion_to) {
-    result += toupper(move.promotion_to);
+  if (move.IsPromotion()) {
+    result += move.PromotionTo();
   }
-  bool is_check = false;
+  const bool is_check = board.GivesCheck(move);
   bool is_mate = false;
-  if (move.board.IsKingInCheck(move.board.WhiteToMove())) {
-    is_check = true;
-  }
   if (is_check) {
     MoveCalculator calculator;
-    is_mate = calculator.CalculateAllMoves(move.board).empty();
+    is_mate = !calculator.HasAnyLegalMove(board.BoardAfterMove(move));
   }
   if (is_mate) {
     result += '#';
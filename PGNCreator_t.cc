@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cctype>
 #include <sstream>
 #include <string>
 #include <tuple>
@@ -15,16 +16,16 @@
 
 namespace {
 
-std::vector<Move>::const_iterator FindMove(const std::vector<Move>& moves, const std::string& move_str) {
+const Move* FindMove(const MoveList& moves, const std::string& move_str) {
   assert(move_str.size() == 4u || move_str.size() == 5u);
   return std::find_if(moves.begin(), moves.end(), [move_str](const Move& move) -> bool {
-    if (move_str.length() == 5u && move_str[4] != move.promotion_to) {
+    if (move_str.length() == 5u && toupper(move_str[4]) != move.PromotionTo()) {
       return false;
     }
-    return static_cast<size_t>(move_str[0] - 'a') == move.old_x &&
-           static_cast<size_t>(move_str[1] - '1') == move.old_y &&
-           static_cast<size_t>(move_str[2] - 'a') == move.new_x &&
-           static_cast<size_t>(move_str[3] - '1') == move.new_y;
+    return static_cast<size_t>(move_str[0] - 'a') == move.OldX() &&
+           static_cast<size_t>(move_str[1] - '1') == move.OldY() &&
+           static_cast<size_t>(move_str[2] - 'a') == move.NewX() &&
+           static_cast<size_t>(move_str[3] - '1') == move.NewY();
   });
 }
 
@@ -96,7 +97,7 @@ TEST_PROCEDURE(PGNCreator_whole_game) {
       auto iter = FindMove(moves, move_str);
       VERIFY_TRUE(iter != moves.end()) << "failed for fen \"" << fen << "\" and move " << move_str;
       pgn_creator.AddMove(board, *iter);
-      board = iter->board;
+      board.MakeMove(*iter);
     }
     pgn_creator.GameFinished(result);
     VERIFY_EQUALS(pgn_creator.GetPGN(), expected_fen) << "failed for fen \"" << fen << "\" and moves " << moves_str;
@@ -0,0 +1,247 @@
+/* Counts leaf nodes of the legal move tree, for validating and benchmarking
+   move generation.
+
+   Usage:
+     perft [options]                   runs all built-in positions and
+                                       compares counts
+     perft [options] <depth> [<fen>]   prints counts for each root move (divide)
+
+   Options:
+     -t <threads>   number of worker threads (default: number of cores)
+     -m <MB>        size of subtree count cache, 0 disables it (default: 64)
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Board.h"
+#include "HashEntry.h"
+#include "MoveCalculator.h"
+#include "Stopwatch.h"
+#include "utils/Utils.h"
+
+
+namespace {
+
+const char* StartingPosition = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+struct PerftCase {
+  const char* fen;
+  unsigned depth;
+  uint64_t nodes;
+};
+
+const std::vector<PerftCase> PerftCases = {
+  {StartingPosition, 6u, 119060324u},
+  {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 5u, 193690690u},
+  {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 6u, 11030083u},
+  {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 5u, 15833292u},
+  {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4u, 2103487u},
+  {"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4u, 3894594u}
+};
+
+// Cache of subtree node counts shared by all worker threads without locking
+// (see HashEntry). Entry data keeps depth in the low 8 bits and the count
+// above them.
+class PerftTable {
+ public:
+  explicit PerftTable(size_t size_in_mb) {
+    const size_t max_entries = (size_in_mb << 20) / sizeof(HashEntry);
+    while (size_ * 2u <= max_entries) {
+      size_ *= 2u;
+    }
+    if (max_entries > 0u) {
+      entries_.reset(new HashEntry[size_]);
+    }
+  }
+
+  bool Probe(uint64_t hash, unsigned depth, uint64_t& nodes) const {
+    if (!entries_) {
+      return false;
+    }
+    uint64_t data = 0u;
+    if (!entries_[hash & (size_ - 1)].Load(hash, data) || (data & 0xff) != depth) {
+      return false;
+    }
+    nodes = data >> 8;
+    return true;
+  }
+
+  void Store(uint64_t hash, unsigned depth, uint64_t nodes) {
+    if (!entries_) {
+      return;
+    }
+    entries_[hash & (size_ - 1)].Store(hash, (nodes << 8) | depth);
+  }
+
+ private:
+  size_t size_{1u};
+  std::unique_ptr<HashEntry[]> entries_;
+};
+
+uint64_t Perft(Board& board, unsigned depth, PerftTable& table) {
+  uint64_t nodes = 0u;
+  if (depth > 1u && table.Probe(board.Hash(), depth, nodes)) {
+    return nodes;
+  }
+  MoveCalculator calculator;
+  // Bulk counting: moves on the last ply don't have to be played.
+  if (depth == 1u) {
+    return calculator.CountLegalMoves(board);
+  }
+  const MoveList moves = calculator.CalculateAllMoves(board);
+  for (const auto& move: moves) {
+    const UndoInfo undo = board.MakeMove(move);
+    nodes += Perft(board, depth - 1, table);
+    board.UnmakeMove(move, undo);
+  }
+  table.Store(board.Hash(), depth, nodes);
+  return nodes;
+}
+
+// Counts nodes below every root move. Root moves are handed out to worker
+// threads one by one, so that threads which got small subtrees pick up more.
+std::vector<uint64_t> PerftRootMoves(const Board& board,
+                                     const MoveList& moves,
+                                     unsigned depth,
+                                     unsigned threads,
+                                     PerftTable& table) {
+  std::vector<uint64_t> result(moves.size(), 1u);
+  if (depth <= 1u) {
+    return result;
+  }
+  std::atomic<size_t> next_move{0u};
+  auto worker = [&]() {
+    Board local_board = board;
+    for (size_t i = next_move++; i < moves.size(); i = next_move++) {
+      const UndoInfo undo = local_board.MakeMove(moves[i]);
+      result[i] = Perft(local_board, depth - 1, table);
+      local_board.UnmakeMove(moves[i], undo);
+    }
+  };
+  std::vector<std::thread> workers;
+  for (unsigned i = 1; i < threads; ++i) {
+    workers.emplace_back(worker);
+  }
+  worker();
+  for (auto& t: workers) {
+    t.join();
+  }
+  return result;
+}
+
+uint64_t CountNodes(const Board& board, unsigned depth, unsigned threads, PerftTable& table) {
+  if (depth == 0u) {
+    return 1u;
+  }
+  MoveCalculator calculator;
+  const MoveList moves = calculator.CalculateAllMoves(board);
+  uint64_t nodes = 0u;
+  for (const auto count: PerftRootMoves(board, moves, depth, threads, table)) {
+    nodes += count;
+  }
+  return nodes;
+}
+
+void PrintSummary(uint64_t nodes, double seconds) {
+  std::cout << "Nodes: " << nodes << ", time: " << seconds << "s";
+  if (seconds > 0.0) {
+    std::cout << ", NPS: " << static_cast<uint64_t>(nodes / seconds);
+  }
+  std::cout << std::endl;
+}
+
+uint64_t Divide(const Board& board, unsigned depth, unsigned threads, PerftTable& table) {
+  if (depth == 0u) {
+    return 1u;
+  }
+  MoveCalculator calculator;
+  const MoveList moves = calculator.CalculateAllMoves(board);
+  const std::vector<uint64_t> counts = PerftRootMoves(board, moves, depth, threads, table);
+  uint64_t nodes = 0u;
+  for (size_t i = 0; i < moves.size(); ++i) {
+    std::cout << moves[i];
+    if (moves[i].IsPromotion()) {
+      std::cout << static_cast<char>(tolower(moves[i].PromotionTo()));
+    }
+    std::cout << ": " << counts[i] << std::endl;
+    nodes += counts[i];
+  }
+  return nodes;
+}
+
+bool RunAllCases(unsigned threads, PerftTable& table) {
+  bool all_ok = true;
+  uint64_t total_nodes = 0u;
+  Stopwatch total;
+  for (const auto& perft_case: PerftCases) {
+    Board board(perft_case.fen);
+    Stopwatch stopwatch;
+    const uint64_t nodes = CountNodes(board, perft_case.depth, threads, table);
+    const double seconds = stopwatch.Seconds();
+    total_nodes += nodes;
+    const bool ok = nodes == perft_case.nodes;
+    all_ok = all_ok && ok;
+    std::cout << perft_case.fen << " depth " << perft_case.depth << ": " << nodes;
+    if (!ok) {
+      std::cout << " (expected " << perft_case.nodes << ")";
+    }
+    std::cout << (ok ? " OK" : " NOT OK") << ", " << seconds << "s" << std::endl;
+  }
+  PrintSummary(total_nodes, total.Seconds());
+  return all_ok;
+}
+
+int PrintUsage(const char* name) {
+  std::cerr << "Usage: " << name << " [-t <threads>] [-m <MB>] [<depth> [<fen>]]" << std::endl;
+  return 1;
+}
+
+}  // unnamed namespace
+
+
+int main(int argc, char* argv[]) {
+  unsigned threads = std::max(std::thread::hardware_concurrency(), 1u);
+  size_t table_size_in_mb = 64u;
+  int arg = 1;
+  for (; arg + 1 < argc && argv[arg][0] == '-'; arg += 2) {
+    if (!strcmp(argv[arg], "-t")) {
+      if (!utils::str_2_number(argv[arg + 1], threads) || threads == 0u) {
+        return PrintUsage(argv[0]);
+      }
+    } else if (!strcmp(argv[arg], "-m")) {
+      if (!utils::str_2_number(argv[arg + 1], table_size_in_mb)) {
+        return PrintUsage(argv[0]);
+      }
+    } else {
+      return PrintUsage(argv[0]);
+    }
+  }
+  PerftTable table(table_size_in_mb);
+  if (arg == argc) {
+    return RunAllCases(threads, table) ? 0 : 1;
+  }
+  unsigned depth = 0u;
+  if (argc - arg > 2 || !utils::str_2_number(argv[arg], depth)) {
+    return PrintUsage(argv[0]);
+  }
+  const char* fen = (argc - arg == 2) ? argv[arg + 1] : StartingPosition;
+  try {
+    Board board(fen);
+    Stopwatch stopwatch;
+    const uint64_t nodes = Divide(board, depth, threads, table);
+    PrintSummary(nodes, stopwatch.Seconds());
+  } catch (const InvalidFENException&) {
+    std::cerr << "Invalid FEN: " << fen << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,68 @@
+#ifndef PIECE_H
+#define PIECE_H
+
+#include <cstdint>
+
+#include "Bitboard.h"
+
+// Figure together with its color: figure type + 1 in bits 0-2 and color in
+// bit 3 (set for white), so that zero stands for an empty square.
+enum Piece : uint8_t {
+  NO_PIECE = 0,
+  BLACK_PAWN = 1,
+  BLACK_KNIGHT,
+  BLACK_BISHOP,
+  BLACK_ROOK,
+  BLACK_QUEEN,
+  BLACK_KING,
+  WHITE_PAWN = 9,
+  WHITE_KNIGHT,
+  WHITE_BISHOP,
+  WHITE_ROOK,
+  WHITE_QUEEN,
+  WHITE_KING,
+  PIECES = 16
+};
+
+constexpr Piece MakePiece(bool white, FigureType type) {
+  return static_cast<Piece>((white ? 8 : 0) | (type + 1));
+}
+
+// Mustn't be called for NO_PIECE.
+constexpr FigureType TypeOf(Piece piece) {
+  return static_cast<FigureType>((piece & 7) - 1);
+}
+
+constexpr bool IsWhite(Piece piece) {
+  return piece & 8;
+}
+
+// FEN letters; '\0' for NO_PIECE and unused codes.
+constexpr char PieceChars[PIECES] = {
+  '\0', 'p', 'n', 'b', 'r', 'q', 'k', '\0',
+  '\0', 'P', 'N', 'B', 'R', 'Q', 'K', '\0'
+};
+
+// Material in pawns, positive for white and negative for black.
+constexpr int PieceValues[PIECES] = {
+  0, -1, -3, -3, -5, -8, 0, 0,
+  0, 1, 3, 3, 5, 8, 0, 0
+};
+
+// Bishops, rooks and queens, whose attacks can be blocked.
+constexpr bool PieceIsSlider[PIECES] = {
+  false, false, false, true, true, true, false, false,
+  false, false, false, true, true, true, false, false
+};
+
+// Returns NO_PIECE for chars which are not FEN letters.
+inline Piece PieceFromChar(char c) {
+  for (uint8_t piece = 0; piece < PIECES; ++piece) {
+    if (c != '\0' && PieceChars[piece] == c) {
+      return static_cast<Piece>(piece);
+    }
+  }
+  return NO_PIECE;
+}
+
+#endif  // PIECE_H
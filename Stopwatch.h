@@ -0,0 +1,20 @@
+#ifndef STOPWATCH_H_
+#define STOPWATCH_H_
+
+#include <chrono>
+
+// Measures time elapsed since construction.
+class Stopwatch {
+ public:
+  double Seconds() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+  }
+  double Milliseconds() const {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_).count();
+  }
+
+ private:
+  const std::chrono::steady_clock::time_point start_{std::chrono::steady_clock::now()};
+};
+
+#endif  // STOPWATCH_H_
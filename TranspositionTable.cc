@@ -0,0 +1,80 @@
+#include "TranspositionTable.h"
+
+#include <algorithm>
+
+
+TranspositionTable::TranspositionTable(size_t size_in_mb) {
+  Resize(size_in_mb);
+}
+
+void TranspositionTable::Resize(size_t size_in_mb) {
+  const size_t max_buckets = std::max((size_in_mb << 20) / sizeof(Bucket), size_t(1));
+  size_ = 1u;
+  while (size_ * 2u <= max_buckets) {
+    size_ *= 2u;
+  }
+  buckets_.reset(new Bucket[size_]);
+}
+
+void TranspositionTable::Clear() {
+  for (size_t i = 0; i < size_; ++i) {
+    for (auto& entry: buckets_[i].entries) {
+      entry.Clear();
+    }
+  }
+}
+
+uint64_t TranspositionTable::Pack(Move move, int score, unsigned depth, Bound bound, unsigned generation) {
+  const uint64_t raw_move = move.From() | (move.To() << 6) | (uint64_t(move.GetFlags()) << 12);
+  return raw_move |
+         (uint64_t(static_cast<uint32_t>(score)) << 16) |
+         (uint64_t(std::min(depth, 0xffu)) << 48) |
+         (uint64_t(bound) << 56) |
+         (uint64_t(generation) << 58);
+}
+
+TranspositionTable::Data TranspositionTable::Unpack(uint64_t data) {
+  Data result;
+  result.move = Move(data & 0x3f, (data >> 6) & 0x3f, (data >> 12) & 0xf);
+  result.score = static_cast<int32_t>(static_cast<uint32_t>(data >> 16));
+  result.depth = (data >> 48) & 0xff;
+  result.bound = static_cast<Bound>((data >> 56) & 0x3);
+  return result;
+}
+
+bool TranspositionTable::Probe(uint64_t hash, Data& data) const {
+  for (const auto& entry: BucketFor(hash).entries) {
+    uint64_t entry_data = 0u;
+    if (entry.Load(hash, entry_data) && entry_data != 0u) {
+      data = Unpack(entry_data);
+      return true;
+    }
+  }
+  return false;
+}
+
+void TranspositionTable::Store(uint64_t hash, Move move, int score, unsigned depth, Bound bound) {
+  // Entry of the same position is overwritten; otherwise the one with the
+  // shallowest search goes, counting every generation of age as 8 plies.
+  HashEntry* victim = nullptr;
+  int victim_worth = 0;
+  for (auto& entry: BucketFor(hash).entries) {
+    uint64_t entry_data = 0u;
+    if (entry.Load(hash, entry_data) || entry_data == 0u) {
+      if (move.IsNull() && entry_data != 0u) {
+        // Search which failed low doesn't know a good move; an older one
+        // is still worth trying first.
+        move = Unpack(entry_data).move;
+      }
+      victim = &entry;
+      break;
+    }
+    const unsigned age = (generation_ - GenerationOf(entry_data)) & GENERATION_MASK;
+    const int worth = static_cast<int>(Unpack(entry_data).depth) - 8 * static_cast<int>(age);
+    if (!victim || worth < victim_worth) {
+      victim = &entry;
+      victim_worth = worth;
+    }
+  }
+  victim->Store(hash, Pack(move, score, depth, bound, generation_));
+}
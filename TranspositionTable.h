@@ -0,0 +1,63 @@
+#ifndef TRANSPOSITION_TABLE_H_
+#define TRANSPOSITION_TABLE_H_
+
+#include <cstdint>
+#include <memory>
+
+#include "HashEntry.h"
+#include "Move.h"
+
+// Search results keyed by Zobrist hash, shared by all search threads
+// without locking (see HashEntry).
+class TranspositionTable {
+ public:
+  enum Bound : uint8_t {
+    NONE,
+    // Score is at most the stored one (search failed low).
+    UPPER,
+    // Score is at least the stored one (search failed high).
+    LOWER,
+    EXACT
+  };
+
+  struct Data {
+    Move move;
+    int score;
+    unsigned depth;
+    Bound bound;
+  };
+
+  explicit TranspositionTable(size_t size_in_mb);
+
+  // Drops all entries.
+  void Resize(size_t size_in_mb);
+  void Clear();
+  // Called once per search, so that entries left by earlier searches are
+  // the first ones to be replaced.
+  void NewSearch() { generation_ = (generation_ + 1u) & GENERATION_MASK; }
+
+  bool Probe(uint64_t hash, Data& data) const;
+  void Store(uint64_t hash, Move move, int score, unsigned depth, Bound bound);
+
+ private:
+  static const unsigned BUCKET_SIZE = 4u;
+  static const unsigned GENERATION_MASK = 0x3f;
+
+  // Entries sharing an index; one bucket fills a cache line. Entry data
+  // keeps move in bits 0-15, score in bits 16-47, depth in bits 48-55,
+  // bound in bits 56-57 and generation in bits 58-63.
+  struct alignas(64) Bucket {
+    HashEntry entries[BUCKET_SIZE];
+  };
+
+  static uint64_t Pack(Move move, int score, unsigned depth, Bound bound, unsigned generation);
+  static Data Unpack(uint64_t data);
+  static unsigned GenerationOf(uint64_t data) { return data >> 58; }
+  Bucket& BucketFor(uint64_t hash) const { return buckets_[hash & (size_ - 1)]; }
+
+  size_t size_{1u};
+  std::unique_ptr<Bucket[]> buckets_;
+  unsigned generation_{0u};
+};
+
+#endif  // TRANSPOSITION_TABLE_H_
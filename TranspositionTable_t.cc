@@ -0,0 +1,79 @@
+/* Component tests for class TranspositionTable */
+
+#include <cstdint>
+#include <vector>
+
+#include "Move.h"
+#include "TranspositionTable.h"
+#include "utils/Test.h"
+
+
+namespace {
+
+// Hashes differing only in high bits share a bucket in any table size.
+uint64_t SameBucketHash(unsigned n) {
+  return (uint64_t(n + 1u) << 40) | 0x1234u;
+}
+
+// ===============================================================
+
+TEST_PROCEDURE(TranspositionTable_stores_and_probes_entries) {
+  TEST_START
+  TranspositionTable table(1u);
+  const Move move(12u, 28u, Move::DOUBLE_PAWN_PUSH);
+  table.Store(0xdeadbeefcafebabeull, move, -99990, 7u, TranspositionTable::LOWER);
+  TranspositionTable::Data data;
+  VERIFY_TRUE(table.Probe(0xdeadbeefcafebabeull, data));
+  VERIFY_TRUE(data.move == move);
+  VERIFY_EQUALS(data.score, -99990);
+  VERIFY_EQUALS(data.depth, 7u);
+  VERIFY_EQUALS(data.bound, TranspositionTable::LOWER);
+  VERIFY_FALSE(table.Probe(0xdeadbeefcafebabfull, data));
+  table.Clear();
+  VERIFY_FALSE(table.Probe(0xdeadbeefcafebabeull, data));
+  TEST_END
+}
+
+TEST_PROCEDURE(TranspositionTable_keeps_move_of_failed_low_search) {
+  TEST_START
+  TranspositionTable table(1u);
+  const Move move(1u, 18u);
+  table.Store(42u, move, 50, 3u, TranspositionTable::EXACT);
+  table.Store(42u, Move(), 10, 4u, TranspositionTable::UPPER);
+  TranspositionTable::Data data;
+  VERIFY_TRUE(table.Probe(42u, data));
+  VERIFY_TRUE(data.move == move);
+  VERIFY_EQUALS(data.depth, 4u);
+  VERIFY_EQUALS(data.bound, TranspositionTable::UPPER);
+  TEST_END
+}
+
+TEST_PROCEDURE(TranspositionTable_replaces_shallow_and_old_entries) {
+  TEST_START
+  TranspositionTable table(1u);
+  const std::vector<unsigned> depths = {5u, 2u, 9u, 7u};
+  for (unsigned i = 0; i < depths.size(); ++i) {
+    table.Store(SameBucketHash(i), Move(), 0, depths[i], TranspositionTable::EXACT);
+  }
+  // Bucket is full, so the shallowest entry gives way.
+  table.Store(SameBucketHash(4u), Move(), 0, 3u, TranspositionTable::EXACT);
+  TranspositionTable::Data data;
+  VERIFY_FALSE(table.Probe(SameBucketHash(1u), data));
+  VERIFY_TRUE(table.Probe(SameBucketHash(4u), data));
+  // Entries from earlier searches go before deeper ones of the current one:
+  // once the two shallowest old entries are replaced by new entries of
+  // depth 1, an old entry of depth 7 is the next to go, ahead of them.
+  table.NewSearch();
+  table.Store(SameBucketHash(5u), Move(), 0, 1u, TranspositionTable::EXACT);
+  table.Store(SameBucketHash(6u), Move(), 0, 1u, TranspositionTable::EXACT);
+  VERIFY_FALSE(table.Probe(SameBucketHash(4u), data));
+  VERIFY_FALSE(table.Probe(SameBucketHash(0u), data));
+  table.Store(SameBucketHash(7u), Move(), 0, 1u, TranspositionTable::EXACT);
+  VERIFY_FALSE(table.Probe(SameBucketHash(3u), data));
+  for (const unsigned i: {2u, 5u, 6u, 7u}) {
+    VERIFY_TRUE(table.Probe(SameBucketHash(i), data)) << "failed for entry " << i;
+  }
+  TEST_END
+}
+
+}  // unnamed namespace